@@ -0,0 +1,704 @@
+/*
+===============================================================================
+SOURCE FILE:    Bench.c
+                    Definition file for the benchmark harness of the Client
+                    and Server programs.
+
+PROGRAM:        Bench
+
+FUNCTIONS:      int main(int argc, char** argv)
+                int ReadBenchArguments(int argc, char** argv)
+                void BenchHelp(void)
+                long ReadSize(const char* text)
+                int ReadPriorities(const char* text)
+                int SplitArguments(char* line, char** argv, int max)
+                int CreateBenchFile(const char* name, long size)
+                pid_t StartServer(void)
+                int StopServer(pid_t server, struct rusage* usage)
+                int RunClients(pid_t server, Sample* samples)
+                pid_t LaunchClient(int priority)
+                int AskServerStats(unsigned long* requests,
+                                   unsigned long* chunks)
+                int HasOption(const char* options, char option)
+                void Summarize(Sample* samples, int count, int priority,
+                               Summary* summary)
+                double Percentile(double* sorted, int count, double p)
+                void ReportCsv(Summary* summaries, int count)
+                void ReportJson(Summary* summaries, int count)
+                static double Seconds(struct timeval* tv)
+                static double Elapsed(struct timespec* start)
+                static int CompareLatency(const void* a, const void* b)
+
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER:     agent
+
+NOTES:
+Bench never reads the Clients' output, so the cost of a transfer is what the
+Server and the Client spend on it and nothing else.
+===============================================================================
+*/
+
+#include "Bench.h"
+
+char serverOptions[BUFF] = "";      // Options passed to the Server.
+char clientOptions[BUFF] = "";      // Options passed to every Client.
+char fileName[BUFF] = "";           // File every Client requests.
+long fileSize = BENCH_DEFAULT_SIZE; // Size of the file requested.
+int madeFile = 0;                   // The file was made for this run.
+int clients = 1;                    // Clients running at once.
+int requests = 1;                   // Requests made by each Client.
+int priorities[BENCH_MAXPRIORITIES] = { 1 };
+int priorityCount = 1;
+int json = 0;                       // Report JSON instead of CSV.
+int header = 1;                     // Start the CSV with its header.
+
+double wall = 0;                    // Seconds taken by every request.
+double runMessages = -1;            // Put on the queues, -1 if not known.
+int serverRunning = 1;              // The Server has not exited yet.
+struct rusage serverUsage;          // CPU time of the Server.
+
+static double Seconds(struct timeval* tv)
+{
+    return tv->tv_sec + tv->tv_usec / 1e6;
+}
+
+static double Elapsed(struct timespec* start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) +
+        (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static int CompareLatency(const void* a, const void* b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char** argv)
+{
+    Summary summaries[BENCH_MAXPRIORITIES + 1];
+    unsigned long requestsBefore;
+    unsigned long requestsAfter;
+    unsigned long chunksBefore;
+    unsigned long chunksAfter;
+    Sample* samples;
+    pid_t server;
+    int counted;
+    int count;
+    int i;
+
+    if(ReadBenchArguments(argc, argv) < 0)
+        return 1;
+
+    if(fileName[0] == '\0')
+    {
+        snprintf(fileName, BUFF, BENCH_FILE, (int)getpid());
+        if(CreateBenchFile(fileName, fileSize) < 0)
+        {
+            printf("Cannot create %s\n", fileName);
+            return 1;
+        }
+        madeFile = 1;
+    }
+
+    if((samples = calloc(clients * requests, sizeof(Sample))) == NULL)
+        return 1;
+
+    if((server = StartServer()) < 0)
+    {
+        printf("Cannot start the Server.\n");
+        return 1;
+    }
+
+    // Size the messages the same way the Server and the Clients do.
+    if(HasOption(serverOptions, 'P'))
+        messageData = PosixMessageLimit();
+    else if(OpenQueue() == 0)
+        messageData = QueueMessageLimit(msgQueue);
+
+    counted = AskServerStats(&requestsBefore, &chunksBefore) == 0;
+    count = RunClients(server, samples);
+
+    // The first answer and the second request fall between the two.
+    if(counted && serverRunning &&
+        AskServerStats(&requestsAfter, &chunksAfter) == 0)
+    {
+        runMessages = (double)(requestsAfter - requestsBefore - 1) +
+            (chunksAfter - chunksBefore - BENCH_STATS_REPLIES);
+    }
+
+    if(serverRunning && StopServer(server, &serverUsage) < 0)
+        printf("The Server had to be killed.\n");
+
+    for(i = 0; i < priorityCount; i++)
+    {
+        Summarize(samples, count, priorities[i], &summaries[i]);
+    }
+    Summarize(samples, count, 0, &summaries[priorityCount]);
+
+    if(json)
+        ReportJson(summaries, priorityCount + 1);
+    else
+        ReportCsv(summaries, priorityCount + 1);
+
+    if(madeFile)
+        unlink(fileName);
+
+    free(samples);
+    return 0;
+}
+
+int ReadBenchArguments(int argc, char** argv)
+{
+    struct stat st;
+    int opt;
+
+    while((opt = getopt(argc, argv, "s:C:c:n:b:F:p:jH")) != -1)
+    {
+        switch(opt)
+        {
+        case 's':
+            snprintf(serverOptions, BUFF, "%s", optarg);
+            break;
+        case 'C':
+            snprintf(clientOptions, BUFF, "%s", optarg);
+            break;
+        case 'c':
+            clients = atoi(optarg);
+            if(clients < 1 || clients > BENCH_MAXCLIENTS)
+            {
+                BenchHelp();
+                return -1;
+            }
+            break;
+        case 'n':
+            if((requests = atoi(optarg)) < 1)
+            {
+                BenchHelp();
+                return -1;
+            }
+            break;
+        case 'b':
+            if((fileSize = ReadSize(optarg)) < 0)
+            {
+                BenchHelp();
+                return -1;
+            }
+            break;
+        case 'F':
+            snprintf(fileName, BUFF, "%s", optarg);
+            if(stat(fileName, &st) < 0)
+            {
+                printf("Cannot read %s\n", fileName);
+                return -1;
+            }
+            fileSize = st.st_size;
+            break;
+        case 'p':
+            if((priorityCount = ReadPriorities(optarg)) < 1)
+            {
+                BenchHelp();
+                return -1;
+            }
+            break;
+        case 'j':
+            json = 1;
+            break;
+        case 'H':
+            header = 0;
+            break;
+        default:
+            BenchHelp();
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+void BenchHelp(void)
+{
+    printf("Usage: ./Bench [-s \"server options\"] [-C \"client options\"] "
+        "[-c clients]\n");
+    printf("               [-n requests] [-b bytes | -F file] "
+        "[-p priorities] [-j] [-H]\n");
+    printf("  -s options  options passed to the Server.\n");
+    printf("  -C options  options passed to every Client.\n");
+    printf("  -c clients  clients running at once (max %d).\n",
+        BENCH_MAXCLIENTS);
+    printf("  -n requests requests made by each client.\n");
+    printf("  -b bytes    size of the file made for the run (K/M/G).\n");
+    printf("  -F file     request an existing file instead.\n");
+    printf("  -p list     priorities handed out in turn, e.g. 1,10,100.\n");
+    printf("  -j          report JSON instead of CSV.\n");
+    printf("  -H          leave out the CSV header.\n");
+}
+
+long ReadSize(const char* text)
+{
+    char* end;
+    long size;
+
+    size = strtol(text, &end, 10);
+    if(end == text || size < 0)
+        return -1;
+
+    switch(*end)
+    {
+    case 'G':
+    case 'g':
+        size <<= 10;
+        /* fall through */
+    case 'M':
+    case 'm':
+        size <<= 10;
+        /* fall through */
+    case 'K':
+    case 'k':
+        size <<= 10;
+        break;
+    case '\0':
+        break;
+    default:
+        return -1;
+    }
+
+    return size;
+}
+
+int ReadPriorities(const char* text)
+{
+    char* end;
+    int count = 0;
+    long priority;
+
+    while(*text != '\0' && count < BENCH_MAXPRIORITIES)
+    {
+        priority = strtol(text, &end, 10);
+        if(end == text || priority < 1 || priority > 1000)
+            return -1;
+
+        priorities[count++] = priority;
+
+        text = end;
+        if(*text == ',')
+            text++;
+    }
+
+    return count;
+}
+
+int SplitArguments(char* line, char** argv, int max)
+{
+    char* token;
+    int count = 0;
+
+    for(token = strtok(line, " "); token != NULL && count < max;
+        token = strtok(NULL, " "))
+    {
+        argv[count++] = token;
+    }
+
+    return count;
+}
+
+int CreateBenchFile(const char* name, long size)
+{
+    char block[65536];
+    FILE* fp;
+    size_t n;
+    size_t i;
+
+    if((fp = fopen(name, "w")) == NULL)
+        return -1;
+
+    srand(size);
+    while(size > 0)
+    {
+        n = (size < (long)sizeof(block)) ? (size_t)size : sizeof(block);
+        for(i = 0; i < n; i++)
+        {
+            block[i] = rand();
+        }
+
+        if(fwrite(block, sizeof(char), n, fp) != n)
+        {
+            fclose(fp);
+            return -1;
+        }
+        size -= n;
+    }
+
+    return fclose(fp);
+}
+
+pid_t StartServer(void)
+{
+    char options[BUFF];
+    char* argv[BENCH_MAXARGS + 2];
+    pid_t server;
+    int argc;
+    int out;
+
+    if((server = fork()) != 0)
+    {
+        if(server > 0)
+            usleep(BENCH_STARTUP);
+
+        return server;
+    }
+
+    strcpy(options, serverOptions);
+    argv[0] = BENCH_SERVER;
+    argc = 1 + SplitArguments(options, argv + 1, BENCH_MAXARGS);
+    argv[argc] = NULL;
+
+    if((out = open("/dev/null", O_WRONLY)) >= 0)
+        dup2(out, STDOUT_FILENO);
+
+    execv(BENCH_SERVER, argv);
+    _exit(127);
+}
+
+int StopServer(pid_t server, struct rusage* usage)
+{
+    int tries;
+
+    for(tries = 0; tries < BENCH_STOP_TRIES; tries++)
+    {
+        kill(server, SIGINT);
+        usleep(100000);
+
+        if(wait4(server, NULL, WNOHANG, usage) == server)
+            return 0;
+    }
+
+    kill(server, SIGKILL);
+    wait4(server, NULL, 0, usage);
+    return -1;
+}
+
+int RunClients(pid_t server, Sample* samples)
+{
+    struct timespec started[BENCH_MAXCLIENTS];
+    struct timespec start;
+    pid_t running[BENCH_MAXCLIENTS];
+    int priority[BENCH_MAXCLIENTS];
+    struct rusage usage;
+    int total = clients * requests;
+    int launched = 0;
+    int count = 0;
+    int status;
+    pid_t pid;
+    int i;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for(i = 0; i < clients; i++)
+    {
+        running[i] = -1;
+        if(launched < total)
+        {
+            priority[i] = priorities[launched++ % priorityCount];
+            clock_gettime(CLOCK_MONOTONIC, &started[i]);
+            running[i] = LaunchClient(priority[i]);
+        }
+    }
+
+    while(count < total)
+    {
+        if((pid = wait4(-1, &status, 0, &usage)) < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            break;
+        }
+
+        if(pid == server)
+        {
+            printf("The Server stopped during the run.\n");
+            serverUsage = usage;
+            serverRunning = 0;
+            break;
+        }
+
+        for(i = 0; i < clients && running[i] != pid; i++)
+        {
+        }
+        if(i == clients)
+            continue;
+
+        samples[count].priority = priority[i];
+        samples[count].latency = Elapsed(&started[i]);
+        samples[count].failed = !WIFEXITED(status) || WEXITSTATUS(status);
+        samples[count].user = Seconds(&usage.ru_utime);
+        samples[count].sys = Seconds(&usage.ru_stime);
+        count++;
+
+        // Keep the same number of Clients running.
+        running[i] = -1;
+        if(launched < total)
+        {
+            priority[i] = priorities[launched++ % priorityCount];
+            clock_gettime(CLOCK_MONOTONIC, &started[i]);
+            running[i] = LaunchClient(priority[i]);
+        }
+    }
+
+    wall = Elapsed(&start);
+
+    for(i = 0; i < clients; i++)
+    {
+        if(running[i] > 0)
+        {
+            kill(running[i], SIGINT);
+            waitpid(running[i], NULL, 0);
+        }
+    }
+
+    return count;
+}
+
+pid_t LaunchClient(int priority)
+{
+    char options[BUFF];
+    char number[16];
+    char* argv[BENCH_MAXARGS + 4];
+    pid_t client;
+    int argc;
+    int out;
+
+    if((client = fork()) != 0)
+        return client;
+
+    strcpy(options, clientOptions);
+    argv[0] = BENCH_CLIENT;
+    argc = 1 + SplitArguments(options, argv + 1, BENCH_MAXARGS);
+    snprintf(number, sizeof(number), "%d", priority);
+    argv[argc++] = fileName;
+    argv[argc++] = number;
+    argv[argc] = NULL;
+
+    if((out = open("/dev/null", O_WRONLY)) >= 0)
+        dup2(out, STDOUT_FILENO);
+
+    execv(BENCH_CLIENT, argv);
+    _exit(127);
+}
+
+int AskServerStats(unsigned long* requests, unsigned long* chunks)
+{
+    char answer[BUFF * 2];
+    char* argv[4];
+    const char* found;
+    size_t got = 0;
+    ssize_t n;
+    pid_t client;
+    int status;
+    int fds[2];
+    int argc = 0;
+
+    if(pipe(fds) < 0)
+        return -1;
+
+    if((client = fork()) == 0)
+    {
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+
+        argv[argc++] = BENCH_CLIENT;
+        if(HasOption(serverOptions, 'P'))
+            argv[argc++] = "-P";
+        argv[argc++] = "-i";
+        argv[argc] = NULL;
+
+        execv(BENCH_CLIENT, argv);
+        _exit(127);
+    }
+
+    close(fds[1]);
+    if(client < 0)
+    {
+        close(fds[0]);
+        return -1;
+    }
+
+    while(got < sizeof(answer) - 1 &&
+        (n = read(fds[0], answer + got, sizeof(answer) - 1 - got)) > 0)
+    {
+        got += n;
+    }
+    answer[got] = '\0';
+    close(fds[0]);
+
+    if(waitpid(client, &status, 0) < 0 || !WIFEXITED(status) ||
+        WEXITSTATUS(status) != 0)
+        return -1;
+
+    if((found = strstr(answer, "\"requests\":")) == NULL ||
+        sscanf(found, "\"requests\":%lu", requests) != 1 ||
+        (found = strstr(answer, "\"chunks\":")) == NULL ||
+        sscanf(found, "\"chunks\":%lu", chunks) != 1)
+        return -1;
+
+    return 0;
+}
+
+int HasOption(const char* options, char option)
+{
+    char copy[BUFF];
+    char* argv[BENCH_MAXARGS];
+    int argc;
+    int i;
+
+    strcpy(copy, options);
+    argc = SplitArguments(copy, argv, BENCH_MAXARGS);
+
+    // Flags may be grouped as in "-Pe", the values of options never start
+    // with a dash.
+    for(i = 0; i < argc; i++)
+    {
+        if(argv[i][0] == '-' && strchr(argv[i] + 1, option) != NULL)
+            return 1;
+    }
+
+    return 0;
+}
+
+void Summarize(Sample* samples, int count, int priority, Summary* summary)
+{
+    double* sorted;
+    int n = 0;
+    int i;
+
+    memset(summary, 0, sizeof(Summary));
+    summary->priority = priority;
+
+    // Only the run as a whole is counted by the Server.
+    summary->messages = (priority == 0) ? runMessages : -1;
+
+    if((sorted = malloc((count + 1) * sizeof(double))) == NULL)
+        return;
+
+    for(i = 0; i < count; i++)
+    {
+        if(priority != 0 && samples[i].priority != priority)
+            continue;
+
+        summary->requests++;
+        summary->failed += samples[i].failed;
+        summary->bytes += fileSize;
+        summary->user += samples[i].user;
+        summary->sys += samples[i].sys;
+        sorted[n++] = samples[i].latency;
+    }
+
+    qsort(sorted, n, sizeof(double), CompareLatency);
+    summary->p50 = Percentile(sorted, n, 0.50);
+    summary->p99 = Percentile(sorted, n, 0.99);
+    summary->p999 = Percentile(sorted, n, 0.999);
+
+    free(sorted);
+}
+
+double Percentile(double* sorted, int count, double p)
+{
+    int rank;
+
+    if(count == 0)
+        return 0;
+
+    rank = (int)(p * count + 0.999999);
+    if(rank < 1)
+        rank = 1;
+
+    return sorted[rank - 1];
+}
+
+void ReportCsv(Summary* summaries, int count)
+{
+    Summary* s;
+    int i;
+
+    if(header)
+    {
+        printf("server,client,clients,bytes,priority,requests,failed,"
+            "wall_s,mb_s,msgs_s,p50_ms,p99_ms,p999_ms,"
+            "server_user_s,server_sys_s,client_user_s,client_sys_s\n");
+    }
+
+    for(i = 0; i < count; i++)
+    {
+        s = &summaries[i];
+        if(s->priority != 0 && s->requests == 0)
+            continue;
+
+        printf("\"%s\",\"%s\",%d,%ld,", serverOptions, clientOptions,
+            clients, fileSize);
+
+        if(s->priority == 0)
+            printf("all,");
+        else
+            printf("%d,", s->priority);
+
+        printf("%d,%d,%.3f,%.2f,", s->requests, s->failed, wall,
+            s->bytes / (1 << 20) / wall);
+
+        // Left empty when the number of messages is not known.
+        if(s->messages >= 0)
+            printf("%.0f", s->messages / wall);
+
+        printf(",%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n",
+            s->p50 * 1e3, s->p99 * 1e3, s->p999 * 1e3,
+            Seconds(&serverUsage.ru_utime), Seconds(&serverUsage.ru_stime),
+            s->user, s->sys);
+    }
+}
+
+void ReportJson(Summary* summaries, int count)
+{
+    Summary* s;
+    int i;
+
+    printf("{\"server\":\"%s\",\"client\":\"%s\",\"clients\":%d,"
+        "\"bytes\":%ld,\"wall_s\":%.3f,"
+        "\"server_user_s\":%.3f,\"server_sys_s\":%.3f,\"results\":[",
+        serverOptions, clientOptions, clients, fileSize, wall,
+        Seconds(&serverUsage.ru_utime), Seconds(&serverUsage.ru_stime));
+
+    for(i = 0; i < count; i++)
+    {
+        s = &summaries[i];
+
+        printf("%s{\"priority\":", (i > 0) ? "," : "");
+        if(s->priority == 0)
+            printf("\"all\"");
+        else
+            printf("%d", s->priority);
+
+        printf(",\"requests\":%d,\"failed\":%d,\"mb_s\":%.2f,",
+            s->requests, s->failed, s->bytes / (1 << 20) / wall);
+
+        if(s->messages >= 0)
+            printf("\"msgs_s\":%.0f,", s->messages / wall);
+        else
+            printf("\"msgs_s\":null,");
+
+        printf("\"p50_ms\":%.3f,\"p99_ms\":%.3f,"
+            "\"p999_ms\":%.3f,\"client_user_s\":%.3f,"
+            "\"client_sys_s\":%.3f}",
+            s->p50 * 1e3, s->p99 * 1e3, s->p999 * 1e3, s->user, s->sys);
+    }
+
+    printf("]}\n");
+}
@@ -0,0 +1,533 @@
+/*
+===============================================================================
+SOURCE FILE:    Bench.h
+                    Header file for the benchmark harness of the Client and
+                    Server programs.
+
+PROGRAM:        Bench
+
+FUNCTIONS:      int main(int argc, char** argv)
+                int ReadBenchArguments(int argc, char** argv)
+                void BenchHelp(void)
+                long ReadSize(const char* text)
+                int ReadPriorities(const char* text)
+                int SplitArguments(char* line, char** argv, int max)
+                int CreateBenchFile(const char* name, long size)
+                pid_t StartServer(void)
+                int StopServer(pid_t server, struct rusage* usage)
+                int RunClients(pid_t server, Sample* samples)
+                pid_t LaunchClient(int priority)
+                int AskServerStats(unsigned long* requests,
+                                   unsigned long* chunks)
+                int HasOption(const char* options, char option)
+                void Summarize(Sample* samples, int count, int priority,
+                               Summary* summary)
+                double Percentile(double* sorted, int count, double p)
+                void ReportCsv(Summary* summaries, int count)
+                void ReportJson(Summary* summaries, int count)
+
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER:     agent
+
+NOTES:
+Replaces the old runHigh/runLow makefile targets which ran one Client and
+printed the date. Bench starts the Server with the given options, keeps a
+number of Clients running at once until every request has been made, then
+stops the Server and reports:
+    - throughput in MB/s and messages per second,
+    - the p50/p99/p999 latency of a request, from the start of its Client
+      to its exit,
+    - the user and system CPU time of the Server, its children included,
+      and of the Clients.
+One row (CSV) or object (JSON) is reported per priority plus one for every
+request, so the runs of different transports and scheduling modes can be
+appended to one file and compared.
+
+The Clients' output goes to /dev/null. The messages are counted by the Server
+itself: its statistics (Client -i) are read before and after the run, and
+msgs_s is the requests plus the chunks sent in between, whatever the
+transport, chunk size or grouping. The counters cover the whole Server, so
+only the row for every request has msgs_s; the rows of single priorities
+leave it empty, or null in JSON, as does a run whose statistics could not be
+read.
+
+Bench must run from the directory holding Server, Client and the Info file
+used for the queue key.
+===============================================================================
+*/
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <time.h>
+#include <sys/time.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "Utilities.h"
+#include "PosixQueue.h"
+
+#define BENCH_SERVER        "./Server"
+#define BENCH_CLIENT        "./Client"
+#define BENCH_FILE          "/tmp/mqbench.%d"   // File made for a run
+#define BENCH_DEFAULT_SIZE  (1L << 20)          // Bytes per request
+#define BENCH_MAXARGS       32      // Most options passed to a program
+#define BENCH_MAXCLIENTS    256     // Most Clients running at once
+#define BENCH_MAXPRIORITIES 16      // Most priorities in one run
+#define BENCH_STARTUP       300000  // Microseconds for the Server to start
+#define BENCH_STOP_TRIES    50      // SIGINTs sent before SIGKILL
+#define BENCH_STATS_REPLIES 2       // Line and final message of a stats request
+
+/* One finished request. */
+typedef struct
+{
+    int priority;
+    int failed;                 // The Client did not exit with 0
+    double latency;             // Seconds from start to exit
+    double user;                // CPU time of the Client
+    double sys;
+} Sample;
+
+/* Results of every request of one priority, 0 for all of them. */
+typedef struct
+{
+    int priority;
+    int requests;
+    int failed;
+    double bytes;
+    double messages;
+    double p50;
+    double p99;
+    double p999;
+    double user;
+    double sys;
+} Summary;
+
+/*
+===============================================================================
+FUNCTION:       Main
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int main(int argc, char** argv)
+
+PARAMETERS:     int argc
+                    The number of arguments received from command-line.
+                char** argv
+                    The arguments received from the command-line.
+
+RETURNS:        -Returns 1 when the benchmark could not be run.
+                -Returns 0 once the results have been reported.
+
+NOTES:
+Usage: ./Bench [-s "server options"] [-C "client options"] [-c clients]
+               [-n requests] [-b bytes | -F file] [-p priorities] [-j] [-H]
+===============================================================================
+*/
+int main(int argc, char** argv);
+
+/*
+===============================================================================
+FUNCTION:       Read Bench Arguments
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int ReadBenchArguments(int argc, char** argv)
+
+PARAMETERS:     int argc
+                    The number of arguments received from command-line.
+                char** argv
+                    The arguments received from the command-line.
+
+RETURNS:        -Returns -1 on improper options.
+                -Returns 0 on success.
+
+NOTES:
+Parses the Bench options:
+    -s options  Options passed to the Server, "-P -w 4" for example.
+    -C options  Options passed to every Client, "-r" for example.
+    -c clients  Clients running at once.
+    -n requests Requests made by each of the Clients, one after another.
+    -b bytes    Size of the file made for the run, K/M/G may follow.
+    -F file     Request an existing file instead.
+    -p list     Priorities handed out in turn, "1,10,100" for example.
+    -j          Report JSON instead of CSV.
+    -H          Leave out the CSV header, to append to earlier runs.
+===============================================================================
+*/
+int ReadBenchArguments(int argc, char** argv);
+
+/*
+===============================================================================
+FUNCTION:       Bench Help
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void BenchHelp(void)
+
+PARAMETERS:     void
+
+RETURNS:        void
+
+NOTES:
+Prints the usage of Bench.
+===============================================================================
+*/
+void BenchHelp(void);
+
+/*
+===============================================================================
+FUNCTION:       Read Size
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      long ReadSize(const char* text)
+
+PARAMETERS:     const char* text
+                    A number of bytes, optionally followed by K, M or G.
+
+RETURNS:        -Returns -1 if the text is not a size.
+                -Returns the number of bytes.
+===============================================================================
+*/
+long ReadSize(const char* text);
+
+/*
+===============================================================================
+FUNCTION:       Read Priorities
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int ReadPriorities(const char* text)
+
+PARAMETERS:     const char* text
+                    Priorities separated by commas.
+
+RETURNS:        -Returns -1 if a priority is not within 1-1000.
+                -Returns the number of priorities read.
+===============================================================================
+*/
+int ReadPriorities(const char* text);
+
+/*
+===============================================================================
+FUNCTION:       Split Arguments
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int SplitArguments(char* line, char** argv, int max)
+
+PARAMETERS:     char* line
+                    Options separated by spaces, split in place.
+                char** argv
+                    Destination of the options.
+                int max
+                    Room left in argv.
+
+RETURNS:        The number of options placed in argv.
+===============================================================================
+*/
+int SplitArguments(char* line, char** argv, int max);
+
+/*
+===============================================================================
+FUNCTION:       Create Bench File
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int CreateBenchFile(const char* name, long size)
+
+PARAMETERS:     const char* name
+                    File to create.
+                long size
+                    Number of bytes to write.
+
+RETURNS:        -Returns -1 on failure to write the file.
+                -Returns 0 on success.
+
+NOTES:
+Fills the file with pseudo-random bytes so that nothing along the way can
+treat it as text.
+===============================================================================
+*/
+int CreateBenchFile(const char* name, long size);
+
+/*
+===============================================================================
+FUNCTION:       Start Server
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      pid_t StartServer(void)
+
+PARAMETERS:     void
+
+RETURNS:        -Returns -1 on failure to start the Server.
+                -Returns the PID of the Server.
+
+NOTES:
+Starts the Server with its output sent to /dev/null and gives it
+BENCH_STARTUP microseconds to open its queue.
+===============================================================================
+*/
+pid_t StartServer(void);
+
+/*
+===============================================================================
+FUNCTION:       Stop Server
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int StopServer(pid_t server, struct rusage* usage)
+
+PARAMETERS:     pid_t server
+                    PID of the Server.
+                struct rusage* usage
+                    Destination of the CPU time of the Server.
+
+RETURNS:        -Returns -1 if the Server had to be killed.
+                -Returns 0 once the Server has quit.
+
+NOTES:
+Sends SIGINT until the Server quits since a signal which arrives just before
+it waits for a request is lost. The usage includes every child the Server
+has reaped.
+===============================================================================
+*/
+int StopServer(pid_t server, struct rusage* usage);
+
+/*
+===============================================================================
+FUNCTION:       Run Clients
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int RunClients(pid_t server, Sample* samples)
+
+PARAMETERS:     pid_t server
+                    PID of the Server, the run stops if it exits.
+                Sample* samples
+                    Room for one sample per request.
+
+RETURNS:        The number of samples taken.
+
+NOTES:
+Keeps the requested number of Clients running, starting the next request as
+soon as a Client exits, until every request has been made.
+===============================================================================
+*/
+int RunClients(pid_t server, Sample* samples);
+
+/*
+===============================================================================
+FUNCTION:       Launch Client
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      pid_t LaunchClient(int priority)
+
+PARAMETERS:     int priority
+                    Priority of the request.
+
+RETURNS:        -Returns -1 on failure to fork.
+                -Returns the PID of the Client.
+===============================================================================
+*/
+pid_t LaunchClient(int priority);
+
+/*
+===============================================================================
+FUNCTION:       Ask Server Stats
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int AskServerStats(unsigned long* requests,
+                                   unsigned long* chunks)
+
+PARAMETERS:     unsigned long* requests
+                    Destination of the requests the Server has taken.
+                unsigned long* chunks
+                    Destination of the replies the Server has sent.
+
+RETURNS:        -Returns -1 if the Client failed or the answer was not read.
+                -Returns 0 on success.
+
+NOTES:
+Runs a Client with -i, and -P for a POSIX Server, and reads the counters out
+of the line of JSON it prints. The stats request is counted among the
+requests before the snapshot is taken, its two replies only after.
+===============================================================================
+*/
+int AskServerStats(unsigned long* requests, unsigned long* chunks);
+
+/*
+===============================================================================
+FUNCTION:       Has Option
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int HasOption(const char* options, char option)
+
+PARAMETERS:     const char* options
+                    Options passed to a program, as given to Bench.
+                char option
+                    Letter of the flag looked for.
+
+RETURNS:        -Returns 1 if the flag is set, alone or grouped.
+                -Returns 0 otherwise.
+===============================================================================
+*/
+int HasOption(const char* options, char option);
+
+/*
+===============================================================================
+FUNCTION:       Summarize
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void Summarize(Sample* samples, int count, int priority,
+                               Summary* summary)
+
+PARAMETERS:     Sample* samples
+                    Every sample of the run.
+                int count
+                    Number of samples.
+                int priority
+                    Priority to summarize, 0 for every sample.
+                Summary* summary
+                    Destination of the results.
+
+RETURNS:        void
+===============================================================================
+*/
+void Summarize(Sample* samples, int count, int priority, Summary* summary);
+
+/*
+===============================================================================
+FUNCTION:       Percentile
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      double Percentile(double* sorted, int count, double p)
+
+PARAMETERS:     double* sorted
+                    Latencies in ascending order.
+                int count
+                    Number of latencies.
+                double p
+                    Fraction of the latencies at or below the result.
+
+RETURNS:        The nearest-rank percentile, 0 when there are no latencies.
+===============================================================================
+*/
+double Percentile(double* sorted, int count, double p);
+
+/*
+===============================================================================
+FUNCTION:       Report Csv
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void ReportCsv(Summary* summaries, int count)
+
+PARAMETERS:     Summary* summaries
+                    One summary per priority followed by the total.
+                int count
+                    Number of summaries.
+
+RETURNS:        void
+===============================================================================
+*/
+void ReportCsv(Summary* summaries, int count);
+
+/*
+===============================================================================
+FUNCTION:       Report Json
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void ReportJson(Summary* summaries, int count)
+
+PARAMETERS:     Summary* summaries
+                    One summary per priority followed by the total.
+                int count
+                    Number of summaries.
+
+RETURNS:        void
+===============================================================================
+*/
+void ReportJson(Summary* summaries, int count);
+
+#endif
@@ -0,0 +1,385 @@
+/*
+===============================================================================
+SOURCE FILE:    Cache.c
+                    Definition file for the Server's shared file content
+                    cache.
+
+PROGRAM:        Server
+
+FUNCTIONS:      Cache* CreateCache(size_t budget)
+                CacheEntry* CacheOpen(Cache* cache, const char* name)
+                const char* CacheData(Cache* cache, CacheEntry* entry)
+                void CacheClose(Cache* cache, CacheEntry* entry)
+                static void LockCache(Cache* cache)
+                static int PinEntry(CacheEntry* entry)
+                static void UnpinEntry(CacheEntry* entry, pid_t pid)
+                static void DropDeadPins(CacheEntry* entry)
+                static void RecoverCache(Cache* cache)
+                static int SameFile(CacheEntry* entry, struct stat* st)
+                static long FindSpace(Cache* cache, size_t size)
+                static CacheEntry* EvictOldest(Cache* cache)
+                static int ReadContents(int fd, char* where, size_t size)
+
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER:     agent
+
+NOTES:
+The arena is handed out first fit between the entries in use. With at most
+CACHE_ENTRIES entries the search is cheap next to reading the file.
+===============================================================================
+*/
+
+#include "Cache.h"
+
+static void RecoverCache(Cache* cache);
+
+/* Takes the lock, repairing it when its previous holder died with it. */
+static void LockCache(Cache* cache)
+{
+    if(pthread_mutex_lock(&cache->lock) == EOWNERDEAD)
+    {
+        pthread_mutex_consistent(&cache->lock);
+        RecoverCache(cache);
+    }
+}
+
+/* Pins the entry for this process, -1 if it has no pin left. */
+static int PinEntry(CacheEntry* entry)
+{
+    int i;
+
+    for(i = 0; i < CACHE_PINS; i++)
+    {
+        if(entry->pins[i] == 0)
+        {
+            entry->pins[i] = getpid();
+            entry->users++;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+/* Gives back one pin of the process. */
+static void UnpinEntry(CacheEntry* entry, pid_t pid)
+{
+    int i;
+
+    for(i = 0; i < CACHE_PINS; i++)
+    {
+        if(entry->pins[i] == pid)
+        {
+            entry->pins[i] = 0;
+            entry->users--;
+            return;
+        }
+    }
+}
+
+/* Gives back the pins of dead processes, and drops what they left behind. */
+static void DropDeadPins(CacheEntry* entry)
+{
+    int i;
+
+    for(i = 0; i < CACHE_PINS; i++)
+    {
+        if(entry->pins[i] != 0 && kill(entry->pins[i], 0) < 0 &&
+            errno == ESRCH)
+        {
+            entry->pins[i] = 0;
+            entry->users--;
+        }
+    }
+
+    // Half read, or waiting for its last user to go.
+    if(entry->users == 0 && (entry->loading || entry->stale))
+    {
+        entry->used = 0;
+        entry->loading = 0;
+    }
+}
+
+/* Drop Dead Pins for every entry. */
+static void RecoverCache(Cache* cache)
+{
+    int i;
+
+    for(i = 0; i < CACHE_ENTRIES; i++)
+    {
+        if(cache->entries[i].used)
+            DropDeadPins(&cache->entries[i]);
+    }
+}
+
+/* The entry was cached from the file as it is now. */
+static int SameFile(CacheEntry* entry, struct stat* st)
+{
+    return entry->dev == st->st_dev &&
+        entry->ino == st->st_ino &&
+        entry->size == st->st_size &&
+        entry->mtime.tv_sec == st->st_mtim.tv_sec &&
+        entry->mtime.tv_nsec == st->st_mtim.tv_nsec;
+}
+
+/* Offset of the first gap of size bytes in the arena, -1 if there is none. */
+static long FindSpace(Cache* cache, size_t size)
+{
+    CacheEntry* entry;
+    size_t start = 0;
+    size_t end;
+    int moved = 1;
+    int i;
+
+    // Move past every entry overlapping the candidate until none do.
+    while(moved)
+    {
+        moved = 0;
+        end = start + size;
+        if(end > cache->budget)
+            return -1;
+
+        for(i = 0; i < CACHE_ENTRIES; i++)
+        {
+            entry = &cache->entries[i];
+            if(!entry->used)
+                continue;
+
+            if(entry->offset < end &&
+                start < entry->offset + (size_t)entry->size)
+            {
+                start = entry->offset + entry->size;
+                moved = 1;
+            }
+        }
+    }
+
+    return start;
+}
+
+/* Drops the least recently used idle entry, NULL if every entry is busy. */
+static CacheEntry* EvictOldest(Cache* cache)
+{
+    CacheEntry* oldest = NULL;
+    CacheEntry* entry;
+    int i;
+
+    for(i = 0; i < CACHE_ENTRIES; i++)
+    {
+        entry = &cache->entries[i];
+        if(!entry->used || entry->users > 0)
+            continue;
+
+        if(oldest == NULL || entry->lastUse < oldest->lastUse)
+            oldest = entry;
+    }
+
+    if(oldest != NULL)
+        oldest->used = 0;
+
+    return oldest;
+}
+
+static int ReadContents(int fd, char* where, size_t size)
+{
+    ssize_t n;
+
+    while(size > 0)
+    {
+        if((n = read(fd, where, size)) <= 0)
+        {
+            if(n < 0 && errno == EINTR)
+                continue;
+            return -1;
+        }
+
+        where += n;
+        size -= n;
+    }
+
+    return 0;
+}
+
+Cache* CreateCache(size_t budget)
+{
+    pthread_mutexattr_t attr;
+    Cache* cache;
+    int shmid;
+
+    shmid = shmget(IPC_PRIVATE, sizeof(Cache) + budget, SHMPERM | IPC_CREAT);
+    if(shmid < 0)
+    {
+        return NULL;
+    }
+
+    cache = shmat(shmid, NULL, 0);
+    shmctl(shmid, IPC_RMID, NULL);
+    if(cache == (void*)-1)
+    {
+        return NULL;
+    }
+
+    memset(cache, 0, sizeof(Cache));
+    cache->budget = budget;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&cache->lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    return cache;
+}
+
+CacheEntry* CacheOpen(Cache* cache, const char* name)
+{
+    CacheEntry* entry;
+    CacheEntry* slot = NULL;
+    struct stat st;
+    long offset;
+    int recovered = 0;
+    int fd;
+    int i;
+
+    if(strlen(name) >= BUFF || (fd = open(name, O_RDONLY)) < 0)
+    {
+        return NULL;
+    }
+
+    if(fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) ||
+        (size_t)st.st_size > CACHE_LARGEST(cache->budget))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    LockCache(cache);
+    cache->clock++;
+
+    for(i = 0; i < CACHE_ENTRIES; i++)
+    {
+        entry = &cache->entries[i];
+        if(!entry->used)
+        {
+            if(slot == NULL)
+                slot = entry;
+            continue;
+        }
+
+        if(strcmp(entry->path, name) != 0 || entry->stale)
+            continue;
+
+        if(SameFile(entry, &st))
+        {
+            // The one reading it may have died part way.
+            if(entry->loading)
+                DropDeadPins(entry);
+
+            if(!entry->used)
+            {
+                if(slot == NULL)
+                    slot = entry;
+                continue;
+            }
+
+            // Somebody else is still reading it, send from the disk.
+            if(entry->loading || PinEntry(entry) < 0)
+            {
+                pthread_mutex_unlock(&cache->lock);
+                close(fd);
+                return NULL;
+            }
+
+            entry->lastUse = cache->clock;
+            pthread_mutex_unlock(&cache->lock);
+            close(fd);
+            return entry;
+        }
+
+        // The file has changed since it was cached.
+        if(entry->users > 0)
+        {
+            entry->stale = 1;
+        }
+        else
+        {
+            entry->used = 0;
+            if(slot == NULL)
+                slot = entry;
+        }
+    }
+
+    // Evict until there is both a free slot and room in the arena.
+    while(slot == NULL || (offset = FindSpace(cache, st.st_size)) < 0)
+    {
+        if((entry = EvictOldest(cache)) == NULL)
+        {
+            // Every entry is busy, unless some are held by the dead.
+            if(!recovered++)
+            {
+                RecoverCache(cache);
+                for(i = 0; slot == NULL && i < CACHE_ENTRIES; i++)
+                {
+                    if(!cache->entries[i].used)
+                        slot = &cache->entries[i];
+                }
+                continue;
+            }
+
+            pthread_mutex_unlock(&cache->lock);
+            close(fd);
+            return NULL;
+        }
+
+        if(slot == NULL)
+            slot = entry;
+    }
+
+    // Reserve the space, the contents are read without the lock.
+    memset(slot, 0, sizeof(CacheEntry));
+    strcpy(slot->path, name);
+    slot->dev = st.st_dev;
+    slot->ino = st.st_ino;
+    slot->size = st.st_size;
+    slot->mtime = st.st_mtim;
+    slot->offset = offset;
+    slot->lastUse = cache->clock;
+    slot->used = 1;
+    slot->loading = 1;
+    PinEntry(slot);
+    pthread_mutex_unlock(&cache->lock);
+
+    i = ReadContents(fd, cache->data + offset, st.st_size);
+    close(fd);
+
+    LockCache(cache);
+    slot->loading = 0;
+    if(i < 0)
+    {
+        slot->used = 0;
+        slot = NULL;
+    }
+    pthread_mutex_unlock(&cache->lock);
+
+    return slot;
+}
+
+const char* CacheData(Cache* cache, CacheEntry* entry)
+{
+    return cache->data + entry->offset;
+}
+
+void CacheClose(Cache* cache, CacheEntry* entry)
+{
+    LockCache(cache);
+    UnpinEntry(entry, getpid());
+    if(entry->users == 0 && entry->stale)
+    {
+        entry->used = 0;
+    }
+    pthread_mutex_unlock(&cache->lock);
+}
@@ -0,0 +1,190 @@
+/*
+===============================================================================
+SOURCE FILE:    Cache.h
+                    Header file for the Server's shared file content cache.
+
+PROGRAM:        Server
+
+FUNCTIONS:      Cache* CreateCache(size_t budget)
+                CacheEntry* CacheOpen(Cache* cache, const char* name)
+                const char* CacheData(Cache* cache, CacheEntry* entry)
+                void CacheClose(Cache* cache, CacheEntry* entry)
+
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER:     agent
+
+NOTES:
+Keeps the contents of the files most recently sent in memory (Server -m) so
+that the same file asked for by many Clients is read from the disk once.
+The cache is a shared memory segment created before any worker is forked, so
+forked children, pre-forked workers and pool threads all see one cache.
+
+An entry is keyed by the path together with the device, inode, size and
+modification time of the file. Every lookup stats the file, so a file that
+has changed since it was cached is never served from memory: the stale
+entry is dropped as soon as nobody is sending from it.
+
+The file contents are kept in one arena of budget bytes. When a new file
+does not fit, the least recently used entries which nobody is sending from
+are evicted until it does. Files larger than a quarter of the budget are
+never cached and are sent straight from the disk as before.
+
+A process-shared robust mutex guards the entries, a worker which dies while
+holding it does not stop the others. The contents themselves are read and
+sent without the lock held, an entry being sent from is pinned instead.
+Every pin records the process which holds it, so the pins of a child which
+died (crashed, or killed in the middle of a transfer) are given back: when
+the lock is found with its owner dead, when nothing is left to evict and
+when an entry seems to be still loading.
+===============================================================================
+*/
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <pthread.h>
+#include <time.h>
+#include <sys/shm.h>
+#include <sys/stat.h>
+#include "Utilities.h"
+
+#define CACHE_ENTRIES       256     // Most files in the cache at once
+#define CACHE_LARGEST(b)    ((b) / 4)   // Largest file cached in b bytes
+#define CACHE_PINS          64      // Most transfers sending from one entry
+
+/* One cached file, its contents are inside of the arena. */
+typedef struct
+{
+    char path[BUFF];
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    struct timespec mtime;
+    size_t offset;              // Start of the contents in the arena
+    unsigned long lastUse;      // Cache clock of the latest lookup
+    int users;                  // Transfers sending from the entry
+    pid_t pins[CACHE_PINS];     // Process of each of them, 0 for none
+    int used;                   // The slot holds a file
+    int loading;                // The contents are still being read
+    int stale;                  // Drop the entry once users reaches 0
+} CacheEntry;
+
+/* Header of the shared memory segment, the arena immediately follows it. */
+typedef struct
+{
+    pthread_mutex_t lock;
+    size_t budget;              // Bytes inside of data
+    unsigned long clock;        // Advanced by every lookup
+    CacheEntry entries[CACHE_ENTRIES];
+    char data[];
+} Cache;
+
+/*
+===============================================================================
+FUNCTION:       Create Cache
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      Cache* CreateCache(size_t budget)
+
+PARAMETERS:     size_t budget
+                    Bytes of file contents the cache may hold.
+
+RETURNS:        -Returns NULL on failure to create the shared memory.
+                -Returns the attached cache on success.
+
+NOTES:
+The segment is marked for removal right away, it disappears once the Server
+and every one of its children have exited. Must be called before the Server
+forks.
+===============================================================================
+*/
+Cache* CreateCache(size_t budget);
+
+/*
+===============================================================================
+FUNCTION:       Cache Open
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      CacheEntry* CacheOpen(Cache* cache, const char* name)
+
+PARAMETERS:     Cache* cache
+                    The Server's cache.
+                const char* name
+                    Path of the file requested by a Client.
+
+RETURNS:        -Returns NULL when the file must be sent from the disk.
+                -Returns the pinned entry holding the file's contents.
+
+NOTES:
+Looks the file up and, on a miss, reads the whole file into the cache.
+NULL is returned for a file that cannot be opened, is not a regular file, is
+too large to cache, is being read into the cache by someone else, is
+already pinned CACHE_PINS times, or does not fit even after evicting every
+idle entry. Every entry returned must be
+given back with Cache Close.
+===============================================================================
+*/
+CacheEntry* CacheOpen(Cache* cache, const char* name);
+
+/*
+===============================================================================
+FUNCTION:       Cache Data
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      const char* CacheData(Cache* cache, CacheEntry* entry)
+
+PARAMETERS:     Cache* cache
+                    The Server's cache.
+                CacheEntry* entry
+                    An entry returned by Cache Open.
+
+RETURNS:        The file's contents, entry->size bytes long.
+===============================================================================
+*/
+const char* CacheData(Cache* cache, CacheEntry* entry);
+
+/*
+===============================================================================
+FUNCTION:       Cache Close
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void CacheClose(Cache* cache, CacheEntry* entry)
+
+PARAMETERS:     Cache* cache
+                    The Server's cache.
+                CacheEntry* entry
+                    An entry returned by Cache Open.
+
+RETURNS:        void
+
+NOTES:
+Unpins the entry, which may then be evicted. A stale entry is dropped here.
+===============================================================================
+*/
+void CacheClose(Cache* cache, CacheEntry* entry);
+
+#endif
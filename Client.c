@@ -7,9 +7,29 @@ PROGRAM:        Client
 
 FUNCTIONS:      int main(void)
                 int Client(void);
+                int ReadOptions(int argc, char** argv)
+                int OpenClientQueues(void)
+                void CloseClientQueues(void)
+                int SendRequest(int queue, Mesg* msg)
                 int ReadArguments(char* request, int argc, char** argv)
                 int CreateReadThread(void);
                 void* ReadServerResponse(void *queue);
+                void FormatRequest(char* request, const char* name)
+                int RunSession(Mesg* snd)
+                void* ReadSessionResponses(void* queue)
+                SessionRequest* FindSessionRequest(long id)
+                void WriteSessionData(SessionRequest* req, Mesg* rcv)
+                void EndSessionRequest(SessionRequest* req)
+                void WriteSpool(SessionRequest* req)
+                void ReleaseSessionRequest(SessionRequest* req)
+                int ReadResponse(int queue, Mesg* msg)
+                int ReadReply(int queue, Mesg* msg)
+                int GrantCredit(int queue, Mesg* grant)
+                void TraceReply(Mesg* rcv, long long received)
+                int ReadCompressionAnswer(Mesg* rcv)
+                void WriteInflated(Mesg* rcv)
+                void ReadServerRing(void)
+                void ReadServerDescriptor(void)
                 void sig_handler(int sig)
 
 
@@ -28,6 +48,48 @@ REVISIONS:      January 31, 2016        (Tyler Trepanier-Bracken)
                     Client has their own definitions of the sig_handler
                     with their own implementations.
 
+                October 17, 2026        (agent)
+                    Added the POSIX message queue backend (-P), each Client
+                    receives its replies on its own POSIX queue.
+
+                October 17, 2026        (agent)
+                    Added the shared memory ring (-r) for bulk transfers.
+
+                October 17, 2026        (agent)
+                    Added zero-copy delivery (-f) of the open file.
+
+                October 17, 2026        (agent)
+                    Messages are allocated to the size of the message data
+                    allowed by the queue.
+
+                October 17, 2026        (agent)
+                    The Client joins its read thread instead of spinning and
+                    its output is fully buffered.
+
+                October 17, 2026        (agent)
+                    Added a private SysV reply queue (-q).
+
+                October 17, 2026        (agent)
+                    Added batch requests (-b) for many files at once.
+
+                October 17, 2026        (agent)
+                    Added the pipelined session (-S), several requests in
+                    flight on one queue and told apart by their mesg_id.
+
+                October 17, 2026        (agent)
+                    Added compressed transfers (-z) when built with
+                    USE_ZLIB.
+
+                October 17, 2026        (agent)
+                    Added credit based flow control (-w), the Server never
+                    has more than the window of chunks on the queue.
+
+                October 17, 2026        (agent)
+                    Added -i, printing the Server's statistics.
+
+                October 17, 2026        (agent)
+                    Added -T, tracing the chunks of traced transfers.
+
 DESIGNGER:      Tyler Trepanier-Bracken
 
 PROGRAMMER:     Tyler Trepanier-Bracken
@@ -47,7 +109,7 @@ This is the main file that holds all of the unique functionality of the Client
 program. There are some shared functionality with the Server that is defined
 inside of the Utilities files.
 
-The sig_handler is defined in this file to account for the detached pthread.
+The sig_handler is defined in this file to account for the read thread.
 ===============================================================================
 */
 
@@ -55,6 +117,10 @@ The sig_handler is defined in this file to account for the detached pthread.
 
 int main(int argc, char** argv)
 {
+    int result;
+
+    // The file is written out in large blocks rather than per message.
+    setvbuf(stdout, NULL, _IOFBF, CLIENT_OUTPUT_BUFFER);
 
     sa.sa_handler = sig_handler;
     sigemptyset (&sa.sa_mask);
@@ -63,72 +129,246 @@ int main(int argc, char** argv)
     sigaction (SIGINT, &sa, &oldint);
     sigaction (SIGTSTP, &sa, NULL);
 
-    Client(argc, argv);
+    result = Client(argc, argv);
+
+    CloseClientQueues();
 
     // Restore normal action
     sigaction (SIGINT, &oldint, NULL);
 
-    return 0;
+    return (result != 0) ? 1 : 0;
 }
 
 int Client(int argc, char** argv)
 {
     long type = CLIENT_TO_SERVER;
     char request[BUFF];
+    int result;
 
-    Mesg snd;
+    Mesg* snd;
 
-    if(OpenQueue() < 0){
+    if(ReadOptions(argc, argv) < 0){
         return 1;
     }
 
-    done = 1;
+    if(OpenClientQueues() < 0){
+        return 1;
+    }
+
+    if((snd = CreateMessage()) == NULL){
+        return 1;
+    }
+
+    if(useRing && (ringId = CreateRing(RING_SIZE, &ring)) < 0){
+        return 1;
+    }
+
+    if(useDescriptor && (fdSocket = OpenDescriptorSocket(getpid())) < 0){
+        return 1;
+    }
+
+    if(useSession)
+    {
+        result = RunSession(snd);
+        free(snd);
+        return result;
+    }
+
+    if(ReadArguments(request, argc, argv) < 0)
+    {
+        return 0;
+    }
 
     if(CreateReadThread() < 0)
         return -1;
 
-    while (running)
+    strncpy(snd->mesg_data, request, BUFF);
+    snd->mesg_len = strlen(snd->mesg_data);
+
+    snd->mesg_type = type;
+    if(SendRequest(msgQueue, snd) < 0)
     {
-        if(done) {
+        return -1;
+    }
 
-            rc = ReadArguments(request, argc, argv);
-            if(rc < 0)
-            {
+    // Sleep until the whole response has been written.
+    pthread_join(reader, NULL);
+    free(snd);
 
-                return 0;
-            } 
-            else if(rc == 1)
-            {
+    return readFailed ? 1 : 0;
+}
 
-                continue;
-            }
+int ReadOptions(int argc, char** argv)
+{
+    int opt;
+
+    while((opt = getopt(argc, argv, "Pn:rfqbSzw:iT:")) != -1)
+    {
+        switch(opt)
+        {
+        case 'P':
+            posix = 1;
+            break;
+        case 'r':
+            useRing = 1;
+            break;
+        case 'f':
+            useDescriptor = 1;
+            break;
+        case 'q':
+            ownQueue = 1;
+            break;
+        case 'b':
+            batch = 1;
+            break;
+        case 'S':
+            useSession = 1;
+            break;
+        case 'z':
+            useZip = 1;
+            break;
+        case 'w':
+            window = atol(optarg);
+            break;
+        case 'i':
+            askStats = 1;
+            break;
+        case 'T':
+            traceDir = optarg;
+            break;
+        case 'n':
+            maxmsg = atol(optarg);
+            break;
+        default:
+            ClientHelp();
+            return -1;
+        }
+    }
 
-            done = 0;
+    // The framing of a batch only exists in the message queue replies.
+    if((batch || useSession) && (useRing || useDescriptor))
+    {
+        ClientHelp();
+        return -1;
+    }
 
-            strncpy(snd.mesg_data, request, BUFF);
+    // The framing of a batch is not kept apart per request of a session.
+    if(batch && useSession)
+    {
+        ClientHelp();
+        return -1;
+    }
 
-            snd.mesg_type = type;
-            if(SendMessage(msgQueue, &snd) < 0)
-            {
-              return -1;
-            }
+#ifndef USE_ZLIB
+    if(useZip)
+    {
+        printf("This Client was built without compression (USE_ZLIB).\n");
+        return -1;
+    }
+#endif
 
-        }
-        
+    // Only a single file read from the message queue is ever compressed.
+    if(useZip && (batch || useSession || useRing || useDescriptor))
+    {
+        ClientHelp();
+        return -1;
+    }
+
+    // The statistics are a single message queue reply.
+    if(askStats && (batch || useSession || useZip || useRing || useDescriptor))
+    {
+        ClientHelp();
+        return -1;
+    }
+
+    // The grants need a SysV queue and a single reader counting the chunks.
+    if(window < 0 || (window > 0 &&
+        (posix || useSession || useRing || useDescriptor)))
+    {
+        ClientHelp();
+        return -1;
     }
 
     return 0;
 }
 
-int CreateReadThread(void)
+int OpenClientQueues(void)
 {
+    char name[MQ_NAME_SIZE];
+
+    if(!posix)
+    {
+        if(OpenQueue() < 0)
+            return -1;
+
+        replyQueue = msgQueue;
 
-    pthread_attr_t detach_attr;
-    pthread_t thread;
+        // Only this Client reads from a private queue, the Server writes.
+        if(ownQueue &&
+            (replyQueue = msgget(IPC_PRIVATE, MSGPERM | IPC_CREAT)) < 0)
+            return -1;
+
+        return 0;
+    }
 
-    pthread_attr_init(&detach_attr);
-    pthread_attr_setdetachstate(&detach_attr, PTHREAD_CREATE_DETACHED);
-    rc = pthread_create(&thread, &detach_attr, ReadServerResponse, (void*)&msgQueue);
+    messageData = PosixMessageLimit();
+
+    // Remove any queue left behind by a previous process with this PID.
+    ClientPosixQueueName(name, getpid());
+    mq_unlink(name);
+
+    replyQueue = OpenPosixQueue(name, O_RDONLY | O_CREAT, maxmsg);
+    if(replyQueue == (mqd_t)-1)
+    {
+        perror("Cannot create the reply queue");
+        return -1;
+    }
+
+    msgQueue = OpenPosixQueue(SERVER_MQ_NAME, O_WRONLY, 0);
+    if(msgQueue == (mqd_t)-1)
+    {
+        perror("Cannot open the request queue of the Server");
+        CloseClientQueues();
+        return -1;
+    }
+
+    return 0;
+}
+
+void CloseClientQueues(void)
+{
+    char name[MQ_NAME_SIZE];
+
+    if(!posix)
+    {
+        if(replyQueue >= 0 && replyQueue != msgQueue)
+            RemoveQueue(replyQueue);
+
+        replyQueue = -1;
+        return;
+    }
+
+    if(replyQueue == (mqd_t)-1)
+        return;
+
+    ClientPosixQueueName(name, getpid());
+    mq_close(replyQueue);
+    mq_unlink(name);
+    replyQueue = -1;
+}
+
+int SendRequest(int queue, Mesg* msg)
+{
+    if(posix)
+        return SendPosixMessage(queue, msg, PosixPriority(priority));
+
+    return SendMessage(queue, msg);
+}
+
+int CreateReadThread(void)
+{
+
+    rc = pthread_create(&reader, NULL, ReadServerResponse, (void*)&replyQueue);
 
     if(rc != 0)
     {
@@ -139,21 +379,28 @@ int CreateReadThread(void)
 
 int ReadArguments(char* request, int argc, char** argv)
 {
-    int priority;
-    int client = getpid();
-
     char name[BUFF];
 
-    //Command line usage: ./Client [filename] [priority]
-    if(argc >= 2)
+    //Command line usage: ./Client [options] [filename] [priority]
+    argc -= optind;
+    argv += optind;
+
+    // The statistics are not a file, the name is only a placeholder.
+    if(askStats)
     {
-        if(sscanf(argv[1], "%s", name) != 1)
+        FormatRequest(request, "stats");
+        return 0;
+    }
+
+    if(argc >= 1)
+    {
+        if(sscanf(argv[0], "%s", name) != 1)
         {
             ClientHelp();
             return -1;
         }
 
-        if(argc == 2 || sscanf(argv[2], "%d", &priority) != 1)
+        if(argc == 1 || sscanf(argv[1], "%d", &priority) != 1)
         {
             priority = 1;
         }
@@ -175,40 +422,564 @@ int ReadArguments(char* request, int argc, char** argv)
         priority = 1000;
     }
 
-    sprintf(request, "%s %d %d", name, priority, client);
+    FormatRequest(request, name);
 
     return 0;
 }
 
+void FormatRequest(char* request, const char* name)
+{
+    request += sprintf(request, "%s %d %d", name, priority, getpid());
+
+    if(ring != NULL)
+    {
+        request += sprintf(request, " ring=%d", ringId);
+    }
+
+    if(fdSocket >= 0)
+    {
+        request += sprintf(request, " fd=1");
+    }
+
+    if(!posix && replyQueue != msgQueue)
+    {
+        request += sprintf(request, " queue=%d", replyQueue);
+    }
+
+    if(batch)
+    {
+        request += sprintf(request, " batch=1");
+    }
+
+    if(useZip)
+    {
+        request += sprintf(request, " zip=1");
+    }
+
+    if(window > 0)
+    {
+        request += sprintf(request, " credit=%ld", window);
+    }
+
+    if(askStats)
+    {
+        sprintf(request, " stats=1");
+    }
+}
+
 void* ReadServerResponse(void* msgQueue)
 {
-    Mesg rcv;
-    rcv.mesg_len = 0;
+    Mesg* rcv;
+    long long received = 0;     // When the reply came off of the queue.
+    long long remaining = 0;    // Bytes left of the current file of a batch.
+    long long size;
+    int n;
+#ifdef USE_ZLIB
+    int answer = useZip;        // The first reply answers a zip=1 request.
+#endif
+
+    if(ring != NULL)
+    {
+        ReadServerRing();
+        return 0;
+    }
+
+    if(fdSocket >= 0)
+    {
+        ReadServerDescriptor();
+        return 0;
+    }
+
+    if((rcv = CreateMessage()) == NULL)
+    {
+        return 0;
+    }
 
     while(1)
     {     
+        if(ReadReply((*(int*)msgQueue), rcv) < 0)
+        {
+            // A removed queue fails every time, only a signal is retried.
+            if(errno == EINTR)
+                continue;
+
+            perror("Cannot read the reply");
+            readFailed = 1;
+            break;
+        }
+
+        if(traceDir != NULL)
+            received = MonotonicNs();
 
-        fflush(stdout);
+        if(rcv->mesg_len == 0) {
+            break;
+        }
 
-        if(ReadMessage((*(int*)msgQueue), &rcv, getpid()) == 0){
-            if(rcv.mesg_len == 0) {
-                break;
+#ifdef USE_ZLIB
+        if(answer)
+        {
+            answer = 0;
+            if(ReadCompressionAnswer(rcv))
+                continue;
+        }
+
+        if(useZip)
+        {
+            WriteInflated(rcv);
+            TraceReply(rcv, received);
+            owed++;
+            continue;
+        }
+#endif
+
+        // Every file of a batch starts with a "size path" header.
+        if(batch && remaining <= 0)
+        {
+            if(sscanf(rcv->mesg_data, "%lld %n", &size, &n) < 1)
+                continue;
+
+            if(size < 0)
+            {
+                printf("Cannot open file: %s\n", rcv->mesg_data + n);
+                continue;
             }
-            
-            printf("%s", rcv.mesg_data);
+
+            printf("==> %s <==\n", rcv->mesg_data + n);
+            remaining = size;
+            continue;
+        }
+        
+        fwrite(rcv->mesg_data, sizeof(char), rcv->mesg_len, stdout);
+        TraceReply(rcv, received);
+        remaining -= rcv->mesg_len;
+        owed++;
+    }
+
+    // A grant sent as the file ended would never be read by the Server.
+    if(window > 0 && !posix)
+    {
+        while(ReadMessageNoWait(*(int*)msgQueue, rcv, CREDIT_TYPE(getpid()))
+            == 0)
+        {
+        }
+    }
+
+    CloseTrace(trace);
+
+#ifdef USE_ZLIB
+    if(useZip)
+    {
+        inflateEnd(&inflater);
+    }
+#endif
+
+    free(rcv);
+
+    return 0;
+}
+
+#ifdef USE_ZLIB
+int ReadCompressionAnswer(Mesg* rcv)
+{
+    if(rcv->mesg_len == 5 && memcmp(rcv->mesg_data, "zip=1", 5) == 0)
+    {
+        memset(&inflater, 0, sizeof(inflater));
+        if(inflateInit(&inflater) == Z_OK)
+            return 1;
+
+        printf("Cannot start decompressing the file.\n");
+    }
+
+    useZip = 0;
+
+    // Anything else is the start of a plain reply from an older Server.
+    return rcv->mesg_len == 5 && memcmp(rcv->mesg_data, "zip=0", 5) == 0;
+}
+
+void WriteInflated(Mesg* rcv)
+{
+    char out[CLIENT_OUTPUT_BUFFER];
+    int status;
+
+    inflater.next_in = (Bytef*)rcv->mesg_data;
+    inflater.avail_in = rcv->mesg_len;
+
+    // One message may inflate to many times its size.
+    do
+    {
+        inflater.next_out = (Bytef*)out;
+        inflater.avail_out = sizeof(out);
+
+        status = inflate(&inflater, Z_NO_FLUSH);
+        if(status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR)
+        {
+            printf("The compressed file is damaged.\n");
+            return;
+        }
+
+        fwrite(out, sizeof(char), sizeof(out) - inflater.avail_out, stdout);
+    } while(inflater.avail_out == 0);
+}
+#endif
+
+void ReadServerRing(void)
+{
+    char* where;
+    size_t n;
+
+    // The ring is written straight to the output, no copy is made.
+    while((n = RingReadSpace(ring, &where)) > 0)
+    {
+        fwrite(where, sizeof(char), n, stdout);
+        RingRelease(ring, n);
+    }
+
+    if(atomic_load(&ring->producer) == 0)
+        fprintf(stderr, "The Server never attached to the ring.\n");
+    else if(!atomic_load(&ring->closed))
+        fprintf(stderr, "The Server stopped before the end of the file.\n");
+    else
+        return;
+
+    readFailed = 1;
+}
+
+void ReadServerDescriptor(void)
+{
+    char text[BUFF + 32];
+    int fd;
+    int n;
+
+    if((n = ReadDescriptor(fdSocket, text, sizeof(text), &fd)) < 0)
+    {
+        readFailed = 1;
+        return;
+    }
+
+    if(fd < 0)
+    {
+        fwrite(text, sizeof(char), n, stdout);
+        return;
+    }
+
+    fflush(stdout);
+    CopyDescriptor(fd, STDOUT_FILENO);
+    close(fd);
+}
+
+int RunSession(Mesg* snd)
+{
+    char request[BUFF];
+    char line[BUFF];
+    char name[BUFF];
+    SessionRequest* slot;
+    long id = 0;
+    int result = 0;
+
+    if(pthread_create(&reader, NULL, ReadSessionResponses,
+        (void*)&replyQueue) != 0)
+    {
+        return -1;
+    }
+
+    snd->mesg_type = CLIENT_TO_SERVER;
+
+    // Each line is sent right away, the replies are sorted out by the reader.
+    while(fgets(line, sizeof(line), stdin) != NULL)
+    {
+        if(sscanf(line, "%255s", name) != 1)
+            continue;
+
+        if(sscanf(line, "%*s %d", &priority) != 1 || priority < 1)
+            priority = 1;
+        else if(priority > 1000)
+            priority = 1000;
+
+        pthread_mutex_lock(&sessionLock);
+        while(inFlight == SESSION_WINDOW && !readFailed)
+        {
+            pthread_cond_wait(&sessionChange, &sessionLock);
+        }
+
+        if(readFailed)
+        {
+            pthread_mutex_unlock(&sessionLock);
+            break;
         }
 
+        for(slot = session; slot->id != 0; slot++)
+        {
+        }
+
+        slot->id = ++id;
+        strcpy(slot->name, name);
+        slot->spool = NULL;
+        slot->finished = 0;
+        inFlight++;
+        pthread_mutex_unlock(&sessionLock);
+
+        FormatRequest(request, name);
+        strncpy(snd->mesg_data, request, BUFF);
+        snd->mesg_len = strlen(snd->mesg_data);
+        snd->mesg_id = id;
+
+        if(SendRequest(msgQueue, snd) < 0)
+        {
+            pthread_mutex_lock(&sessionLock);
+            slot->id = 0;
+            inFlight--;
+            pthread_mutex_unlock(&sessionLock);
+            result = -1;
+            break;
+        }
     }
 
-    running = 0;
+    pthread_mutex_lock(&sessionLock);
+    while(inFlight > 0 && !readFailed)
+    {
+        pthread_cond_wait(&sessionChange, &sessionLock);
+    }
+    pthread_mutex_unlock(&sessionLock);
+
+    if(readFailed)
+        result = -1;
+
+    // Nothing is left in flight, the reader is only waiting on the queue.
+    pthread_cancel(reader);
+    pthread_join(reader, NULL);
+
+    return result;
+}
+
+void* ReadSessionResponses(void* queue)
+{
+    SessionRequest* req;
+    Mesg* rcv;
+    int result;
+
+    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+
+    if((rcv = CreateMessage()) == NULL)
+    {
+        return 0;
+    }
+    pthread_cleanup_push(free, rcv);
+
+    while(1)
+    {
+        // Only ever stopped while waiting, never halfway through a write.
+        pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
+        result = ReadResponse(*(int*)queue, rcv);
+        pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+
+        if(result < 0 && errno != EINTR)
+        {
+            // The replies still in flight will not come, let the session end.
+            perror("Cannot read the reply");
+            pthread_mutex_lock(&sessionLock);
+            readFailed = 1;
+            pthread_cond_broadcast(&sessionChange);
+            pthread_mutex_unlock(&sessionLock);
+            break;
+        }
+
+        if(result < 0 || rcv->mesg_id == 0)
+            continue;
+
+        if((req = FindSessionRequest(rcv->mesg_id)) == NULL)
+            continue;
+
+        if(rcv->mesg_len == 0)
+            EndSessionRequest(req);
+        else
+            WriteSessionData(req, rcv);
+    }
+
+    pthread_cleanup_pop(1);
+    return 0;
+}
+
+SessionRequest* FindSessionRequest(long id)
+{
+    SessionRequest* req = NULL;
+    int i;
+
+    pthread_mutex_lock(&sessionLock);
+    for(i = 0; i < SESSION_WINDOW && req == NULL; i++)
+    {
+        if(session[i].id == id)
+            req = &session[i];
+    }
+    pthread_mutex_unlock(&sessionLock);
+
+    return req;
+}
+
+void WriteSessionData(SessionRequest* req, Mesg* rcv)
+{
+    // The first file to have data is written out while it arrives.
+    if(writing == 0)
+    {
+        writing = req->id;
+        WriteSpool(req);
+    }
+
+    if(writing == req->id)
+    {
+        fwrite(rcv->mesg_data, sizeof(char), rcv->mesg_len, stdout);
+        return;
+    }
+
+    // Held back until the file being written out has finished.
+    if(req->spool == NULL && (req->spool = tmpfile()) == NULL)
+    {
+        return;
+    }
+
+    fwrite(rcv->mesg_data, sizeof(char), rcv->mesg_len, req->spool);
+}
+
+void EndSessionRequest(SessionRequest* req)
+{
+    int busy;
+    int i;
+
+    req->finished = 1;
+    if(writing == req->id)
+    {
+        writing = 0;
+        ReleaseSessionRequest(req);
+    }
+
+    if(writing != 0)
+        return;
+
+    // Write out whatever finished while another file had the output.
+    for(i = 0; i < SESSION_WINDOW; i++)
+    {
+        pthread_mutex_lock(&sessionLock);
+        busy = (session[i].id != 0);
+        pthread_mutex_unlock(&sessionLock);
+
+        if(busy && session[i].finished)
+        {
+            WriteSpool(&session[i]);
+            ReleaseSessionRequest(&session[i]);
+        }
+    }
+}
+
+void WriteSpool(SessionRequest* req)
+{
+    char block[BUFSIZ];
+    size_t n;
+
+    printf("==> %s <==\n", req->name);
+
+    if(req->spool == NULL)
+        return;
+
+    rewind(req->spool);
+    while((n = fread(block, sizeof(char), sizeof(block), req->spool)) > 0)
+    {
+        fwrite(block, sizeof(char), n, stdout);
+    }
+
+    fclose(req->spool);
+    req->spool = NULL;
+}
+
+void ReleaseSessionRequest(SessionRequest* req)
+{
+    pthread_mutex_lock(&sessionLock);
+    req->id = 0;
+    inFlight--;
+    pthread_cond_broadcast(&sessionChange);
+    pthread_mutex_unlock(&sessionLock);
+}
+
+int ReadResponse(int queue, Mesg* msg)
+{
+    if(posix)
+        return ReadPosixMessage(queue, msg);
+
+    return ReadMessage(queue, msg, getpid());
+}
+
+int ReadReply(int queue, Mesg* msg)
+{
+    // Hand back half of the window at a time, never blocking on a full queue.
+    while(window > 0 && owed >= (window + 1) / 2)
+    {
+        // The grant is built in msg, which the next read overwrites anyway.
+        if(GrantCredit(queue, msg) == 0)
+            break;
+
+        if(ReadMessageNoWait(queue, msg, getpid()) == 0)
+            return 0;
+
+        usleep(CREDIT_RETRY_WAIT);
+    }
+
+    return ReadResponse(queue, msg);
+}
+
+void TraceReply(Mesg* rcv, long long received)
+{
+    TraceRecord record;
+
+    // Only the chunks of a transfer the Server traced are numbered.
+    if(traceDir == NULL || rcv->mesg_seq == 0)
+        return;
+
+    if(trace == NULL &&
+        (trace = OpenTrace(traceDir, TRACE_CLIENT, getpid(), rcv->mesg_id))
+        == NULL)
+    {
+        printf("Cannot write the trace into %s.\n", traceDir);
+        traceDir = NULL;
+        return;
+    }
+
+    record.seq = rcv->mesg_seq;
+    record.len = rcv->mesg_len;
+    record.start = received;
+    record.sent = rcv->mesg_sent;
+    record.stage = MonotonicNs() - received;
+    record.blocked = 0;
+    TraceChunk(trace, &record);
+}
+
+int GrantCredit(int queue, Mesg* grant)
+{
+    grant->mesg_type = CREDIT_TYPE(getpid());
+    grant->mesg_len = sprintf(grant->mesg_data, "%ld", owed) + 1;
+    if(SendMessageNoWait(queue, grant) < 0)
+    {
+        return -1;
+    }
 
+    owed = 0;
     return 0;
 }
 
 void ClientHelp(void)
 {
-    printf("Usage: [Filename] [Priority].\n");
+    printf("Usage: [Options] [Filename] [Priority].\n");
     printf("Please note that priority is optional.\n");
+    printf("  -P         use POSIX message queues instead of SysV.\n");
+    printf("  -n maxmsg  capacity of this client's POSIX reply queue.\n");
+    printf("  -r         receive the file through a shared memory ring.\n");
+    printf("  -f         receive the open file from the server.\n");
+    printf("  -q         read the replies from a private SysV queue.\n");
+    printf("  -b         every file matching Filename, a pattern or a "
+        "directory.\n");
+    printf("  -S         keep a session, reading \"Filename [Priority]\" "
+        "lines from stdin.\n");
+    printf("  -z         have the file sent compressed.\n");
+    printf("  -w credits most chunks the server may have on the queue.\n");
+    printf("  -i         print the server's statistics as JSON.\n");
+    printf("  -T dir     trace the chunks of a traced transfer into dir.\n");
 }
 
 /* Simple signal handler */
@@ -220,6 +991,7 @@ void sig_handler(int sig)
 
     sigaction (SIGINT, &oldint, NULL);
     fflush(stdout);
+    CloseClientQueues();
 
     exit(1);
 }
\ No newline at end of file
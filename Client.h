@@ -10,6 +10,26 @@ FUNCTIONS:      int main(void)
         		int PromptUserInput(char* input)
         		int CreateReadThread(void)
         		void* ReadServerResponse(void *queue)
+                int ReadOptions(int argc, char** argv)
+                int OpenClientQueues(void)
+                void CloseClientQueues(void)
+                int SendRequest(int queue, Mesg* msg)
+                void FormatRequest(char* request, const char* name)
+                int RunSession(Mesg* snd)
+                void* ReadSessionResponses(void* queue)
+                SessionRequest* FindSessionRequest(long id)
+                void WriteSessionData(SessionRequest* req, Mesg* rcv)
+                void EndSessionRequest(SessionRequest* req)
+                void WriteSpool(SessionRequest* req)
+                void ReleaseSessionRequest(SessionRequest* req)
+                int ReadResponse(int queue, Mesg* msg)
+                int ReadReply(int queue, Mesg* msg)
+                int GrantCredit(int queue, Mesg* grant)
+                void TraceReply(Mesg* rcv, long long received)
+                int ReadCompressionAnswer(Mesg* rcv)
+                void WriteInflated(Mesg* rcv)
+                void ReadServerRing(void)
+                void ReadServerDescriptor(void)
                 void sig_handler(int sig)
 
 
@@ -32,6 +52,48 @@ REVISIONS:      January 31, 2016        (Tyler Trepanier-Bracken)
                     Removing Prompt User functionality and replacing it
                     with  
 
+                October 17, 2026        (agent)
+                    Added the POSIX message queue backend (-P), each Client
+                    receives its replies on its own POSIX queue.
+
+                October 17, 2026        (agent)
+                    Added the shared memory ring (-r) for bulk transfers.
+
+                October 17, 2026        (agent)
+                    Added zero-copy delivery (-f) of the open file.
+
+                October 17, 2026        (agent)
+                    Messages are allocated to the size of the message data
+                    allowed by the queue.
+
+                October 17, 2026        (agent)
+                    The Client joins its read thread instead of spinning and
+                    its output is fully buffered.
+
+                October 17, 2026        (agent)
+                    Added a private SysV reply queue (-q).
+
+                October 17, 2026        (agent)
+                    Added batch requests (-b) for many files at once.
+
+                October 17, 2026        (agent)
+                    Added the pipelined session (-S), several requests in
+                    flight on one queue and told apart by their mesg_id.
+
+                October 17, 2026        (agent)
+                    Added compressed transfers (-z) when built with
+                    USE_ZLIB.
+
+                October 17, 2026        (agent)
+                    Added credit based flow control (-w), the Server never
+                    has more than the window of chunks on the queue.
+
+                October 17, 2026        (agent)
+                    Added -i, printing the Server's statistics.
+
+                October 17, 2026        (agent)
+                    Added -T, tracing the chunks of traced transfers.
+
 DESIGNGER:      Tyler Trepanier-Bracken
 
 PROGRAMMER:     Tyler Trepanier-Bracken
@@ -55,8 +117,64 @@ inside of the Utilities files.
 
 #include <pthread.h>
 #include "Utilities.h"
-
-int done, running = 1;
+#include "PosixQueue.h"
+#include "Ring.h"
+#include "FdPass.h"
+#include "Trace.h"
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+
+#define CLIENT_OUTPUT_BUFFER    (1 << 16)   // Bytes buffered before a write
+#define SESSION_WINDOW          16          // Most requests of a session in flight
+#define CREDIT_RETRY_WAIT       1000        // Microseconds between grant attempts
+
+/* One request of a session waiting for its replies. */
+typedef struct
+{
+    long id;            // mesg_id of the request, 0 when the slot is free,
+                        // only written and read under sessionLock
+    char name[BUFF];    // The file asked for
+    FILE* spool;        // Replies held back while another file is written
+    int finished;       // The final message has arrived
+} SessionRequest;
+
+pthread_t reader;       // Thread which reads the Server's response.
+int readFailed = 0;     // The reply did not arrive in full.
+
+int posix = 0;          // Use the POSIX message queues instead of SysV.
+long maxmsg = 0;        // Capacity of the POSIX reply queue.
+int priority = 1;       // Priority of the request, 1 to 1000.
+int replyQueue = -1;    // Queue on which the Server's replies arrive.
+
+int useRing = 0;        // Receive the file through a shared memory ring.
+int ringId = -1;        // Shared memory id of the ring.
+Ring* ring = NULL;      // The ring, attached.
+
+int useDescriptor = 0;  // Receive the open file from the Server.
+int ownQueue = 0;       // Read the replies from a private SysV queue.
+int batch = 0;          // Ask for every file matching the name at once.
+
+int useSession = 0;     // Read many requests from stdin, see Run Session.
+SessionRequest session[SESSION_WINDOW];
+int inFlight = 0;       // Slots of the session in use.
+long writing = 0;       // Request being written straight to stdout, 0 if none.
+pthread_mutex_t sessionLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t sessionChange = PTHREAD_COND_INITIALIZER;
+
+int useZip = 0;         // Have the file sent through a zlib stream.
+#ifdef USE_ZLIB
+z_stream inflater;      // Decompresses the replies of a zip=1 request.
+#endif
+int fdSocket = -1;      // Socket on which the open file arrives.
+
+long window = 0;        // Chunks the Server may send ahead, 0 for no limit.
+long owed = 0;          // Chunks written out since the last grant.
+
+int askStats = 0;       // Ask for the Server's statistics instead of a file.
+
+const char* traceDir = NULL;    // Where the replies are traced, -T.
+Trace* trace = NULL;    // Trace of the request, opened by the first chunk.
 
 /*
 ===============================================================================
@@ -93,7 +211,8 @@ RETURNS:        -Returns 1 on improper program exit.
 
 NOTES:
 Main entry point into the program. Divides program functionality based on the 
-command-line arguments into client and server functionality. 
+command-line arguments into client and server functionality. The exit status
+is the one of Client.
 ===============================================================================
 */
 int main(int argc, char** argv);
@@ -109,6 +228,14 @@ REVISIONS:      Febuary 1, 2016 (Tyler Trepanier-Bracken)
                 Febuary 3, 2016     (Tyler Trepanier-Bracken)
                     Removing user input functionality on all ends and instead
                     parsing command-line arguments.
+                October 17, 2026        (agent)
+                    Joins the read thread instead of spinning until it has
+                    finished.
+                October 17, 2026        (agent)
+                    Hands over to Run Session with -S.
+                October 17, 2026        (agent)
+                    Fails when the read thread could not read the whole
+                    reply.
 
 DESIGNER:       Tyler Trepanier-Bracken
 
@@ -121,7 +248,8 @@ PARAMETERS:     int argc
                 char** argv
                     The arguments received from the command-line to be parsed.
 
-RETURNS:        -Returns 1 if the Client was unable to open a message queue.
+RETURNS:        -Returns 1 if the Client was unable to open a message queue
+                 or the reply did not arrive in full.
                 -Returns 0 on proper program termination
 
 NOTES:
@@ -132,7 +260,8 @@ will be padded with the PID of the current process and the optional priority.
 
 Afterwards the server will respond with the contents of the file inside of a
 series of messages. If the server cannot open the file, the server will 
-respond with an error.
+respond with an error. The Client sleeps on the read thread until the whole
+response has been written.
 
 The program will continually asked for user input until user enters "quit" 
 or ctrl-c has been hit.
@@ -146,6 +275,21 @@ FUNCTION:       Read Server Response
 
 DATE:           Febuary 1, 2016
 
+REVISIONS:      October 17, 2026        (agent)
+                    Writes exactly mesg_len bytes of each message so binary
+                    files are displayed intact.
+                October 17, 2026        (agent)
+                    No longer flushes the output before every message, the
+                    output is written in CLIENT_OUTPUT_BUFFER sized blocks.
+                October 17, 2026        (agent)
+                    Reads the framing of a batch, each file is preceded by
+                    a "==> path <==" line as head(1) does.
+                October 17, 2026        (agent)
+                    Inflates the replies of a compressed transfer.
+                October 17, 2026        (agent)
+                    Stops on any error but a signal, setting readFailed,
+                    rather than spinning on a removed queue.
+
 DESIGNER:       Tyler Trepanier-Bracken
 
 PROGRAMMER(S):  Tyler Trepanier-Bracken
@@ -167,6 +311,536 @@ messages in the queue that are meant for this Client.
 */
 void* ReadServerResponse(void *queue);
 
+/*
+===============================================================================
+FUNCTION:       Format Request
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void FormatRequest(char* request, const char* name)
+
+PARAMETERS:     char* request
+                    Filled in with the request text, BUFF bytes long.
+                const char* name
+                    The file to ask for.
+
+RETURNS:        void
+
+NOTES:
+Writes "name priority pid" using the current priority followed by the
+options of this Client, see Read Request Options on the Server.
+===============================================================================
+*/
+void FormatRequest(char* request, const char* name);
+
+/*
+===============================================================================
+FUNCTION:       Run Session
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int RunSession(Mesg* snd)
+
+PARAMETERS:     Mesg* snd
+                    The message the requests are sent in.
+
+RETURNS:        -Returns -1 if the read thread could not start or a request
+                    could not be sent.
+                -Returns 0 once every request has been answered.
+
+NOTES:
+Takes the place of Read Arguments with -S. Each "Filename [Priority]" line
+read from stdin is sent at once, tagged with the next mesg_id, so up to
+SESSION_WINDOW requests are in flight on the one reply queue. The queues,
+the process and the read thread are set up once for every file. Returns
+once stdin is closed and the last reply has arrived, or with -1 as soon as
+the read thread can no longer read the reply queue.
+===============================================================================
+*/
+int RunSession(Mesg* snd);
+
+/*
+===============================================================================
+FUNCTION:       Read Session Responses
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void* ReadSessionResponses(void* queue)
+
+PARAMETERS:     void* queue
+                    Pointer to the queue the replies arrive on.
+
+RETURNS:        Never returns, it is cancelled by Run Session.
+
+NOTES:
+The replies of the requests in flight interleave on the queue, each is
+handed to the request with its mesg_id. Cancellation is only allowed while
+waiting for the next reply.
+===============================================================================
+*/
+void* ReadSessionResponses(void* queue);
+
+/*
+===============================================================================
+FUNCTION:       Write Session Data
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void WriteSessionData(SessionRequest* req, Mesg* rcv)
+
+PARAMETERS:     SessionRequest* req
+                    The request the reply belongs to.
+                Mesg* rcv
+                    The reply.
+
+RETURNS:        void
+
+NOTES:
+One file at a time is written straight to stdout, preceded by a
+"==> name <==" line. The replies of every other file are spooled to a
+temporary file until the output is free, so no file is ever split up.
+===============================================================================
+*/
+void WriteSessionData(SessionRequest* req, Mesg* rcv);
+
+/*
+===============================================================================
+FUNCTION:       End Session Request
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void EndSessionRequest(SessionRequest* req)
+
+PARAMETERS:     SessionRequest* req
+                    The request whose final message arrived.
+
+RETURNS:        void
+
+NOTES:
+Frees the request's slot once its file has been written. When the output
+is free, every spooled request which has finished is written out as well.
+===============================================================================
+*/
+void EndSessionRequest(SessionRequest* req);
+
+/*
+===============================================================================
+FUNCTION:       Write Spool
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void WriteSpool(SessionRequest* req)
+
+PARAMETERS:     SessionRequest* req
+                    The request to start writing out.
+
+RETURNS:        void
+
+NOTES:
+Writes the request's "==> name <==" line and whatever was spooled for it.
+===============================================================================
+*/
+void WriteSpool(SessionRequest* req);
+
+/*
+===============================================================================
+FUNCTION:       Find Session Request
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      SessionRequest* FindSessionRequest(long id)
+
+PARAMETERS:     long id
+                    The mesg_id of a reply.
+
+RETURNS:        -Returns NULL if no request in flight has the id.
+                -Returns the request's slot.
+
+NOTES:
+Looks under sessionLock, since Run Session fills other slots meanwhile.
+The slot found stays the reader's until Release Session Request.
+===============================================================================
+*/
+SessionRequest* FindSessionRequest(long id);
+
+/*
+===============================================================================
+FUNCTION:       Release Session Request
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void ReleaseSessionRequest(SessionRequest* req)
+
+PARAMETERS:     SessionRequest* req
+                    A finished request.
+
+RETURNS:        void
+
+NOTES:
+Frees the slot and wakes Run Session, which may be waiting for one.
+===============================================================================
+*/
+void ReleaseSessionRequest(SessionRequest* req);
+
+/*
+===============================================================================
+FUNCTION:       Read Response
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int ReadResponse(int queue, Mesg* msg)
+
+PARAMETERS:     int queue
+                    The SysV message queue or this Client's POSIX queue.
+                Mesg* msg
+                    Destination message structure.
+
+RETURNS:        -Returns -1 on failure to read a message.
+                -Returns 0 on received message success.
+
+NOTES:
+Reads the next message meant for this Client from whichever backend is in
+use.
+===============================================================================
+*/
+int ReadResponse(int queue, Mesg* msg);
+
+/*
+===============================================================================
+FUNCTION:       Read Reply
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int ReadReply(int queue, Mesg* msg)
+
+PARAMETERS:     int queue
+                    The SysV reply queue.
+                Mesg* msg
+                    Destination message structure.
+
+RETURNS:        Same as Read Response.
+
+NOTES:
+Read Response for a request sent with -w. Once half of the window has been
+written out it is granted back to the Server before waiting for more. When
+the queue is too full to take the grant, the replies still on it are read
+meanwhile so the grant is never held up by the Client itself. Grants go on
+until the final message has been read, chunk sizes say nothing about where
+the file ends.
+===============================================================================
+*/
+int ReadReply(int queue, Mesg* msg);
+
+/*
+===============================================================================
+FUNCTION:       Grant Credit
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int GrantCredit(int queue, Mesg* grant)
+
+PARAMETERS:     int queue
+                    The SysV reply queue, the Server reads the grants from it.
+                Mesg* grant
+                    Message structure the grant is built in.
+
+RETURNS:        -Returns -1 if the queue is full.
+                -Returns 0 once the chunks owed were granted.
+
+NOTES:
+Sends the number of chunks written since the last grant as a message of type
+CREDIT_TYPE(pid).
+===============================================================================
+*/
+int GrantCredit(int queue, Mesg* grant);
+
+/*
+===============================================================================
+FUNCTION:       Trace Reply
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void TraceReply(Mesg* rcv, long long received)
+
+PARAMETERS:     Mesg* rcv
+                    A chunk of the file, just written out.
+                long long received
+                    Monotonic Ns when it came off of the queue.
+
+RETURNS:        void
+
+NOTES:
+Records the chunk into dir/<pid>-<request>.client when the Client was
+started with -T and the Server numbered the chunk, that is when it was
+started with -T too. The time spent writing includes the flushes of stdout,
+so a chunk which filled the buffer carries the cost of writing it.
+===============================================================================
+*/
+void TraceReply(Mesg* rcv, long long received);
+
+#ifdef USE_ZLIB
+/*
+===============================================================================
+FUNCTION:       Read Compression Answer
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int ReadCompressionAnswer(Mesg* rcv)
+
+PARAMETERS:     Mesg* rcv
+                    The first reply to a zip=1 request.
+
+RETURNS:        -Returns 1 if the reply was the Server's answer.
+                -Returns 0 if it is already part of the file.
+
+NOTES:
+Starts the inflater on "zip=1". On "zip=0", or from a Server which does not
+answer, useZip is cleared and the file is written out as it arrives.
+===============================================================================
+*/
+int ReadCompressionAnswer(Mesg* rcv);
+
+/*
+===============================================================================
+FUNCTION:       Write Inflated
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void WriteInflated(Mesg* rcv)
+
+PARAMETERS:     Mesg* rcv
+                    A reply of a compressed transfer.
+
+RETURNS:        void
+
+NOTES:
+Feeds the reply to the inflater and writes out everything it produces.
+===============================================================================
+*/
+void WriteInflated(Mesg* rcv);
+#endif
+
+/*
+===============================================================================
+FUNCTION:       Read Server Ring
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void ReadServerRing(void)
+
+PARAMETERS:     void
+
+RETURNS:        void
+
+NOTES:
+Used by Read Server Response when the file is sent through the shared memory
+ring. Writes the ring to the standard output until the Server closes it.
+Says so on the standard error when the Server never attached to the ring or
+went away before closing it.
+===============================================================================
+*/
+void ReadServerRing(void);
+
+/*
+===============================================================================
+FUNCTION:       Read Server Descriptor
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void ReadServerDescriptor(void)
+
+PARAMETERS:     void
+
+RETURNS:        void
+
+NOTES:
+Used by Read Server Response when the open file was requested. Waits for the
+Server's answer on the descriptor socket and copies the received file to the
+standard output, or displays the Server's error text.
+===============================================================================
+*/
+void ReadServerDescriptor(void);
+
+/*
+===============================================================================
+FUNCTION:       Read Options
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int ReadOptions(int argc, char** argv)
+
+PARAMETERS:     int argc 
+                    The number of arguments received from command-line.
+                char** argv
+                    The arguments received from the command-line to be parsed.
+
+RETURNS:        -Returns -1 on a improper option.
+                -Returns 0 on success.
+
+NOTES:
+Parses the options which come before the filename:
+    -P          Use the POSIX message queues instead of the SysV queue.
+    -n maxmsg   Capacity of this Client's POSIX reply queue.
+    -r          Receive the file through a shared memory ring.
+    -f          Receive the open file from the Server.
+    -q          Read the replies from a private SysV queue.
+    -b          Ask for every file matching the filename, a glob pattern
+                or a directory, in one request. Cannot be used with -r or
+                -f.
+    -S          Keep a session, reading "Filename [Priority]" lines from
+                stdin. Cannot be used with -b, -r or -f.
+    -z          Have the file sent compressed, when built with USE_ZLIB.
+                Only for a single file read from the message queue.
+The remaining arguments are left for Read Arguments.
+===============================================================================
+*/
+int ReadOptions(int argc, char** argv);
+
+/*
+===============================================================================
+FUNCTION:       Open Client Queues
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int OpenClientQueues(void)
+
+PARAMETERS:     void
+
+RETURNS:        -Returns -1 if a queue could not be opened.
+                -Returns 0 on success.
+
+NOTES:
+Opens the queue that requests are sent on (msgQueue) and the queue that the
+replies are read from (replyQueue). Both are the same SysV message queue
+unless this Client asked for a private SysV reply queue (-q) or the POSIX
+backend is selected, in which case this Client creates its own reply queue
+and opens the Server's request queue.
+===============================================================================
+*/
+int OpenClientQueues(void);
+
+/*
+===============================================================================
+FUNCTION:       Close Client Queues
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void CloseClientQueues(void)
+
+PARAMETERS:     void
+
+RETURNS:        void
+
+NOTES:
+Removes this Client's own reply queue, POSIX or SysV. The shared SysV queue
+belongs to the Server and is left alone.
+===============================================================================
+*/
+void CloseClientQueues(void);
+
+/*
+===============================================================================
+FUNCTION:       Send Request
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int SendRequest(int queue, Mesg* msg)
+
+PARAMETERS:     int queue
+                    The SysV message queue or the Server's POSIX queue.
+                Mesg* msg
+                    The request to send.
+
+RETURNS:        -Returns -1 on failure to send the request.
+                -Returns 0 on success.
+
+NOTES:
+Sends the request on whichever backend is in use. On the POSIX backend the
+request is queued at the POSIX priority matching this Client's priority.
+===============================================================================
+*/
+int SendRequest(int queue, Mesg* msg);
+
 /*
 ===============================================================================
 FUNCTION:       Read Arguments
@@ -180,6 +854,8 @@ REVISIONS:      Febuary 2, 2016 (Tyler Trepanier-Bracken)
                 Febuary 3, 2016 (Tyler Trepanier-Bracken)
                     Repurposed this Prompt User Input (this function) to 
                     parsing command-line arguments.
+                October 17, 2026        (agent)
+                    The request text is written by Format Request.
 
 DESIGNER:       Tyler Trepanier-Bracken
 
@@ -199,7 +875,10 @@ RETURNS:        -Returns -1 on a improper argument formatting.
                 -Returns 0 on succesful user input
 
 NOTES:
-This function grabs filenames from the command-line. Whenever there are no
+This function grabs filenames from the command-line. The id of the shared
+memory ring is added to the request when the ring is in use, likewise the
+request asks for the open file when the descriptor socket is in use and
+names the private reply queue when there is one. Whenever there are no
 arguments when the program is instiated, this program will display the usage
 instructions on how this program operates and terminates.
 ===============================================================================
@@ -215,6 +894,8 @@ DATE:           January 30, 2016
 REVISIONS:      Feb 1, 2016     (Tyler Trepanier-Bracken)
                     Set the parameter to be the message queue which is passed
                     to the Read Server Response function
+                October 17, 2026        (agent)
+                    The thread is joinable, the Client waits on it.
 
 DESIGNER:       Tyler Trepanier-Bracken
 
@@ -229,7 +910,7 @@ RETURNS:        -Returns -1 if unable to create the read thread.
 
 NOTES:
 Creates a thread which has the sole purpose of reading all messages from the
-message queue for aimed at this process.
+message queue for aimed at this process. The thread is kept in reader.
 ===============================================================================
 */
 int CreateReadThread(void);
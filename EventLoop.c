@@ -0,0 +1,247 @@
+/*
+===============================================================================
+SOURCE FILE:    EventLoop.c
+                    Definition file for the Server's single threaded event
+                    loop.
+
+PROGRAM:        Server
+
+FUNCTIONS:      int RunEventLoop(int queue)
+                int AcceptRequests(EventLoop* loop, Mesg* rcv)
+                int RunReadyTransfers(EventLoop* loop)
+                int ParkTransfer(EventLoop* loop, Transfer* transfer)
+                void WakeTransfer(EventLoop* loop, Transfer* transfer)
+                void DropTransfer(EventLoop* loop, Transfer* transfer)
+
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER:     agent
+
+NOTES:
+The request queue is registered with a NULL pointer, every Client's queue
+with its Transfer. The Clients' queues are registered with EPOLLONESHOT so a
+parked transfer is woken once and then ignored until parked again.
+===============================================================================
+*/
+
+#include "Server.h"
+
+int RunEventLoop(int queue)
+{
+    struct epoll_event events[EVENT_BATCH];
+    struct epoll_event watch;
+    struct rlimit files;
+    EventLoop loop;
+    Transfer* transfer;
+    Mesg* rcv;
+    long fit;
+    int count;
+    int i;
+
+    if((rcv = CreateMessage()) == NULL)
+    {
+        return 1;
+    }
+
+    // Every transfer keeps its Client's queue open.
+    if(getrlimit(RLIMIT_NOFILE, &files) == 0 && files.rlim_cur < files.rlim_max)
+    {
+        files.rlim_cur = files.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &files);
+    }
+
+    // Every Client's queue is charged to the user's RLIMIT_MSGQUEUE.
+    RaisePosixQueueLimit();
+    if((fit = PosixQueuesFit(MQ_DEFAULT_MAXMSG)) >= 0)
+    {
+        printf("RLIMIT_MSGQUEUE leaves room for about %ld Clients\n", fit);
+    }
+
+    memset(&loop, 0, sizeof(loop));
+    loop.queue = queue;
+    if((loop.epoll = epoll_create1(EPOLL_CLOEXEC)) < 0)
+    {
+        perror("epoll_create1");
+        free(rcv);
+        return 1;
+    }
+
+    memset(&watch, 0, sizeof(watch));
+    watch.events = EPOLLIN;
+    watch.data.ptr = NULL;
+    if(epoll_ctl(loop.epoll, EPOLL_CTL_ADD, queue, &watch) < 0)
+    {
+        perror("epoll_ctl");
+        close(loop.epoll);
+        free(rcv);
+        return 1;
+    }
+
+    while(!quit)
+    {
+        // Only block while every transfer is parked.
+        count = epoll_wait(loop.epoll, events, EVENT_BATCH,
+            (loop.ready != NULL) ? 0 : -1);
+        if(count < 0 && errno != EINTR)
+        {
+            perror("epoll_wait");
+            break;
+        }
+
+        for(i = 0; i < count; i++)
+        {
+            if(events[i].data.ptr == NULL)
+                AcceptRequests(&loop, rcv);
+            else
+                WakeTransfer(&loop, events[i].data.ptr);
+        }
+
+        RunReadyTransfers(&loop);
+        ReapChildren(0);
+    }
+
+    // Let every client know its transfer has stopped.
+    while(loop.parked != NULL)
+    {
+        WakeTransfer(&loop, loop.parked);
+    }
+
+    StopTransfers(loop.ready);
+    while((transfer = loop.ready) != NULL)
+    {
+        loop.ready = transfer->next;
+        DropTransfer(&loop, transfer);
+    }
+
+    close(loop.epoll);
+    free(rcv);
+    return 0;
+}
+
+int AcceptRequests(EventLoop* loop, Mesg* rcv)
+{
+    RequestOptions opts;
+    pid_t child;
+    int count = 0;
+
+    while(!quit && ReadRequestNoWait(loop->queue, rcv) == 0)
+    {
+        count++;
+
+        ReadRequestOptions(rcv->mesg_data, &opts);
+        if(PlainRequest(&opts))
+        {
+            if(AcceptTransfer(&loop->ready, rcv, loop->queue) == 0)
+                loop->transfers++;
+            continue;
+        }
+
+        fflush(stdout);
+        if((child = fork()) == 0)
+        {
+            ProcessClient(rcv, loop->queue);
+            exit(1);
+        }
+        else if(child > 0)
+        {
+            activeChildren++;
+        }
+    }
+
+    return count;
+}
+
+int RunReadyTransfers(EventLoop* loop)
+{
+    Transfer** link = &loop->ready;
+    Transfer* transfer;
+    int sent = 0;
+
+    while((transfer = *link) != NULL)
+    {
+        sent += ServeTransfer(transfer);
+
+        if(transfer->finished && !transfer->loaded)
+        {
+            printf("Sending to %d complete...\n", transfer->client);
+            *link = transfer->next;
+            DropTransfer(loop, transfer);
+            continue;
+        }
+
+        if(transfer->blocked)
+        {
+            *link = transfer->next;
+            if(ParkTransfer(loop, transfer) < 0)
+            {
+                // Cannot be woken, keep it polling with the ready ones.
+                transfer->next = *link;
+                *link = transfer;
+            }
+            else
+            {
+                continue;
+            }
+        }
+
+        link = &transfer->next;
+    }
+
+    return sent;
+}
+
+int ParkTransfer(EventLoop* loop, Transfer* transfer)
+{
+    struct epoll_event watch;
+
+    memset(&watch, 0, sizeof(watch));
+    watch.events = EPOLLOUT | EPOLLONESHOT;
+    watch.data.ptr = transfer;
+
+    if(epoll_ctl(loop->epoll,
+        transfer->registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD,
+        transfer->queue, &watch) < 0)
+    {
+        return -1;
+    }
+
+    transfer->registered = 1;
+
+    transfer->prev = NULL;
+    transfer->next = loop->parked;
+    if(loop->parked != NULL)
+        loop->parked->prev = transfer;
+    loop->parked = transfer;
+
+    return 0;
+}
+
+void WakeTransfer(EventLoop* loop, Transfer* transfer)
+{
+    if(transfer->prev != NULL)
+        transfer->prev->next = transfer->next;
+    else
+        loop->parked = transfer->next;
+
+    if(transfer->next != NULL)
+        transfer->next->prev = transfer->prev;
+
+    // Woken transfers take the next turn.
+    transfer->prev = NULL;
+    transfer->next = loop->ready;
+    loop->ready = transfer;
+}
+
+void DropTransfer(EventLoop* loop, Transfer* transfer)
+{
+    if(transfer->registered)
+    {
+        epoll_ctl(loop->epoll, EPOLL_CTL_DEL, transfer->queue, NULL);
+    }
+
+    loop->transfers--;
+    EndTransfer(transfer);
+}
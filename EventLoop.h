@@ -0,0 +1,224 @@
+/*
+===============================================================================
+SOURCE FILE:    EventLoop.h
+                    Header file for the Server's single threaded event loop.
+
+PROGRAM:        Server
+
+FUNCTIONS:      int RunEventLoop(int queue)
+                int AcceptRequests(EventLoop* loop, Mesg* rcv)
+                int RunReadyTransfers(EventLoop* loop)
+                int ParkTransfer(EventLoop* loop, Transfer* transfer)
+                void WakeTransfer(EventLoop* loop, Transfer* transfer)
+                void DropTransfer(EventLoop* loop, Transfer* transfer)
+
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER:     agent
+
+NOTES:
+An alternative to forking a child per request which only works on the POSIX
+backend (Server -P -e), since on Linux a POSIX queue is a file descriptor
+which epoll can watch and a SysV queue is not. One process drives every
+transfer: the request queue is watched for new requests and every transfer
+is a Transfer of the scheduler (file, loaded chunk, priority and deficit)
+sent without blocking.
+
+A transfer whose Client's queue is full is parked: its queue is registered
+for EPOLLOUT and it is left alone until the Client has read from it. Only
+the transfers with room on their queue take turns, by the same deficit
+round robin as the scheduler, so thousands of slow Clients cost an idle
+descriptor each rather than a process each.
+
+The real limit is the Clients' queues rather than the Server. Each is charged
+in full against the user's RLIMIT_MSGQUEUE, 819200 bytes by default, which
+fits about 38 queues of ten 2 KB messages. The Clients after those get what
+is left in shorter queues and past that cannot start. The system wide
+queues_max (256 by default) caps the queues even with one message each.
+Thousands of Clients need both raised, e.g. "ulimit -Hq unlimited" for the
+user and /proc/sys/fs/mqueue/queues_max. The Server prints how many Clients
+fit when it starts.
+===============================================================================
+*/
+
+#ifndef EVENTLOOP_H
+#define EVENTLOOP_H
+
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include "Utilities.h"
+#include "Scheduler.h"
+
+#define EVENT_BATCH     256     // Most events taken from epoll at once
+
+/* Every transfer of the event loop is either ready or parked. */
+typedef struct EventLoop
+{
+    int epoll;
+    int queue;                  // The POSIX request queue
+    Transfer* ready;            // Transfers with room on their queue
+    Transfer* parked;           // Transfers waiting for room, doubly linked
+    int transfers;              // Number of transfers, ready and parked
+} EventLoop;
+
+/*
+===============================================================================
+FUNCTION:       Run Event Loop
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int RunEventLoop(int queue)
+
+PARAMETERS:     int queue
+                    The POSIX request queue.
+
+RETURNS:        -Returns 1 if the event loop could not be started.
+                -Returns 0 once the Server quits.
+
+NOTES:
+Takes the place of Search For Clients. Blocks in epoll only while no
+transfer is ready, otherwise polls for events between rounds. Raises the
+limit on open descriptors since every Client's queue stays open for the
+length of its transfer, and RLIMIT_MSGQUEUE which those queues are charged
+to. When the Server stops every Client is sent its end with Stop Transfers.
+===============================================================================
+*/
+int RunEventLoop(int queue);
+
+/*
+===============================================================================
+FUNCTION:       Accept Requests
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int AcceptRequests(EventLoop* loop, Mesg* rcv)
+
+PARAMETERS:     EventLoop* loop
+                    The event loop.
+                Mesg* rcv
+                    Message to read the requests into.
+
+RETURNS:        Returns the number of requests taken off of the queue.
+
+NOTES:
+Takes every waiting request off of the request queue. Plain requests join
+the ready transfers, the others (batches, compressed transfers, flow control
+and stats) are handed to a forked child as with the scheduler.
+===============================================================================
+*/
+int AcceptRequests(EventLoop* loop, Mesg* rcv);
+
+/*
+===============================================================================
+FUNCTION:       Run Ready Transfers
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int RunReadyTransfers(EventLoop* loop)
+
+PARAMETERS:     EventLoop* loop
+                    The event loop.
+
+RETURNS:        Returns the number of messages sent.
+
+NOTES:
+Gives every ready transfer one turn. Finished transfers are dropped and the
+ones that found their queue full are parked.
+===============================================================================
+*/
+int RunReadyTransfers(EventLoop* loop);
+
+/*
+===============================================================================
+FUNCTION:       Park Transfer
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int ParkTransfer(EventLoop* loop, Transfer* transfer)
+
+PARAMETERS:     EventLoop* loop
+                    The event loop.
+                Transfer* transfer
+                    A transfer already taken off of the ready list.
+
+RETURNS:        -Returns -1 if the queue could not be watched.
+                -Returns 0 on success.
+
+NOTES:
+Watches the Client's queue for a single EPOLLOUT. The queue stays
+registered once added and is only armed again when parked again.
+===============================================================================
+*/
+int ParkTransfer(EventLoop* loop, Transfer* transfer);
+
+/*
+===============================================================================
+FUNCTION:       Wake Transfer
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void WakeTransfer(EventLoop* loop, Transfer* transfer)
+
+PARAMETERS:     EventLoop* loop
+                    The event loop.
+                Transfer* transfer
+                    A parked transfer whose queue has room.
+
+RETURNS:        void
+
+NOTES:
+Moves the transfer from the parked list to the front of the ready list.
+===============================================================================
+*/
+void WakeTransfer(EventLoop* loop, Transfer* transfer);
+
+/*
+===============================================================================
+FUNCTION:       Drop Transfer
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void DropTransfer(EventLoop* loop, Transfer* transfer)
+
+PARAMETERS:     EventLoop* loop
+                    The event loop.
+                Transfer* transfer
+                    A transfer on neither list.
+
+RETURNS:        void
+
+NOTES:
+Removes the Client's queue from epoll before it is closed. Forked children
+hold copies of the descriptor, so closing it alone would leave it watched.
+===============================================================================
+*/
+void DropTransfer(EventLoop* loop, Transfer* transfer);
+
+#endif
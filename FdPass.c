@@ -0,0 +1,200 @@
+/*
+===============================================================================
+SOURCE FILE:    FdPass.c
+                    Definition file for handing an open file from the Server
+                    to a Client.
+
+PROGRAM:        Client / Server
+
+FUNCTIONS:      int OpenDescriptorSocket(pid_t client)
+                int SendDescriptor(pid_t client, int fd,
+                                   const char* text, size_t len)
+                int ReadDescriptor(int sock, char* text, size_t size,
+                                   int* fd)
+                int CopyDescriptor(int fd, int out)
+                static socklen_t SocketAddress(struct sockaddr_un* addr,
+                                               pid_t client)
+
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER:     agent
+
+NOTES:
+Abstract namespace sockets disappear with the last descriptor so nothing is
+left behind in the file system when a Client dies.
+===============================================================================
+*/
+
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include "FdPass.h"
+
+/* Fills in the abstract address of a Client's socket. */
+static socklen_t SocketAddress(struct sockaddr_un* addr, pid_t client)
+{
+    int n;
+
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    n = snprintf(addr->sun_path + 1, sizeof(addr->sun_path) - 1,
+        FD_SOCKET_NAME, (int)client);
+
+    return offsetof(struct sockaddr_un, sun_path) + 1 + n;
+}
+
+int OpenDescriptorSocket(pid_t client)
+{
+    struct sockaddr_un addr;
+    socklen_t len;
+    int sock;
+
+    if((sock = socket(AF_UNIX, SOCK_DGRAM, 0)) < 0)
+    {
+        return -1;
+    }
+
+    len = SocketAddress(&addr, client);
+    if(bind(sock, (struct sockaddr*)&addr, len) < 0)
+    {
+        close(sock);
+        return -1;
+    }
+
+    return sock;
+}
+
+int SendDescriptor(pid_t client, int fd, const char* text, size_t len)
+{
+    struct sockaddr_un addr;
+    struct msghdr hdr;
+    struct iovec iov;
+    union
+    {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } control;
+    struct cmsghdr* cmsg;
+    int sock;
+    int result;
+
+    if((sock = socket(AF_UNIX, SOCK_DGRAM, 0)) < 0)
+    {
+        return -1;
+    }
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.msg_name = &addr;
+    hdr.msg_namelen = SocketAddress(&addr, client);
+
+    iov.iov_base = (void*)text;
+    iov.iov_len = len;
+    hdr.msg_iov = &iov;
+    hdr.msg_iovlen = 1;
+
+    if(fd >= 0)
+    {
+        memset(&control, 0, sizeof(control));
+        hdr.msg_control = control.buf;
+        hdr.msg_controllen = sizeof(control.buf);
+
+        cmsg = CMSG_FIRSTHDR(&hdr);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+    }
+
+    result = (sendmsg(sock, &hdr, 0) < 0) ? -1 : 0;
+    close(sock);
+
+    return result;
+}
+
+int ReadDescriptor(int sock, char* text, size_t size, int* fd)
+{
+    struct msghdr hdr;
+    struct iovec iov;
+    union
+    {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } control;
+    struct cmsghdr* cmsg;
+    ssize_t n;
+
+    *fd = -1;
+
+    memset(&hdr, 0, sizeof(hdr));
+    iov.iov_base = text;
+    iov.iov_len = size;
+    hdr.msg_iov = &iov;
+    hdr.msg_iovlen = 1;
+    hdr.msg_control = control.buf;
+    hdr.msg_controllen = sizeof(control.buf);
+
+    if((n = recvmsg(sock, &hdr, MSG_CMSG_CLOEXEC)) < 0)
+    {
+        return -1;
+    }
+
+    for(cmsg = CMSG_FIRSTHDR(&hdr); cmsg != NULL;
+        cmsg = CMSG_NXTHDR(&hdr, cmsg))
+    {
+        if(cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+        {
+            memcpy(fd, CMSG_DATA(cmsg), sizeof(int));
+        }
+    }
+
+    return n;
+}
+
+int CopyDescriptor(int fd, int out)
+{
+    struct stat st;
+    ssize_t n;
+    off_t offset = 0;
+    char* map;
+    size_t done = 0;
+
+    if(fstat(fd, &st) < 0)
+    {
+        return -1;
+    }
+
+    while((n = sendfile(out, fd, &offset, st.st_size - offset)) > 0)
+    {
+        if(offset >= st.st_size)
+            return 0;
+    }
+
+    if(n == 0 && offset >= st.st_size)
+    {
+        return 0;
+    }
+
+    // The output does not accept sendfile, write it from a mapping instead.
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(map == MAP_FAILED)
+    {
+        return -1;
+    }
+
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+    done = offset;
+    while(done < (size_t)st.st_size)
+    {
+        if((n = write(out, map + done, st.st_size - done)) <= 0)
+            break;
+
+        done += n;
+    }
+
+    munmap(map, st.st_size);
+
+    return (done == (size_t)st.st_size) ? 0 : -1;
+}
@@ -0,0 +1,160 @@
+/*
+===============================================================================
+SOURCE FILE:    FdPass.h
+                    Header file for handing an open file from the Server to a
+                    Client over a Unix domain socket.
+
+PROGRAM:        Client / Server
+
+FUNCTIONS:      int OpenDescriptorSocket(pid_t client)
+                int SendDescriptor(pid_t client, int fd,
+                                   const char* text, size_t len)
+                int ReadDescriptor(int sock, char* text, size_t size,
+                                   int* fd)
+                int CopyDescriptor(int fd, int out)
+
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER:     agent
+
+NOTES:
+Zero-copy delivery of a whole file. The Client binds a datagram socket in the
+abstract namespace (FD_SOCKET_NAME followed by its PID) and adds "fd=1" to
+its request. The Server opens the file, which is the access check, and sends
+the open descriptor with SCM_RIGHTS. The Client then sends the file to its
+output with sendfile, so the transfer costs one message no matter the size
+of the file.
+
+When the file cannot be opened the Server sends the error text without a
+descriptor.
+===============================================================================
+*/
+
+#ifndef FDPASS_H
+#define FDPASS_H
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "Utilities.h"
+
+#define FD_SOCKET_NAME  "mqfd.%d"   // Abstract socket name of a Client
+
+/*
+===============================================================================
+FUNCTION:       Open Descriptor Socket
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int OpenDescriptorSocket(pid_t client)
+
+PARAMETERS:     pid_t client
+                    PID of the Client, used to name the socket.
+
+RETURNS:        -Returns -1 on failure to create or bind the socket.
+                -Returns the socket on success.
+
+NOTES:
+Used by the Client to create the socket on which the Server's descriptor
+will arrive.
+===============================================================================
+*/
+int OpenDescriptorSocket(pid_t client);
+
+/*
+===============================================================================
+FUNCTION:       Send Descriptor
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int SendDescriptor(pid_t client, int fd,
+                                   const char* text, size_t len)
+
+PARAMETERS:     pid_t client
+                    PID of the Client which owns the socket.
+                int fd
+                    The open file to hand over, -1 to send only the text.
+                const char* text
+                    Text sent along with the descriptor.
+                size_t len
+                    Length of the text, at least 1.
+
+RETURNS:        -Returns -1 on failure to reach the Client.
+                -Returns 0 on success.
+
+NOTES:
+Used by the Server. The descriptor stays open in the Server until it closes
+its own copy.
+===============================================================================
+*/
+int SendDescriptor(pid_t client, int fd, const char* text, size_t len);
+
+/*
+===============================================================================
+FUNCTION:       Read Descriptor
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int ReadDescriptor(int sock, char* text, size_t size,
+                                   int* fd)
+
+PARAMETERS:     int sock
+                    The Client's socket.
+                char* text
+                    Filled in with the text sent by the Server.
+                size_t size
+                    Size of the text buffer.
+                int* fd
+                    Filled in with the received descriptor, -1 if none.
+
+RETURNS:        -Returns -1 on failure to read.
+                -Returns the length of the text on success.
+
+NOTES:
+Used by the Client, blocks until the Server answers.
+===============================================================================
+*/
+int ReadDescriptor(int sock, char* text, size_t size, int* fd);
+
+/*
+===============================================================================
+FUNCTION:       Copy Descriptor
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int CopyDescriptor(int fd, int out)
+
+PARAMETERS:     int fd
+                    The received file.
+                int out
+                    Descriptor to copy the file to.
+
+RETURNS:        -Returns -1 on failure.
+                -Returns 0 once the whole file has been copied.
+
+NOTES:
+Copies with sendfile. If out does not support sendfile, the file is mapped
+with mmap and written out from the mapping instead.
+===============================================================================
+*/
+int CopyDescriptor(int fd, int out);
+
+#endif
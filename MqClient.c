@@ -0,0 +1,568 @@
+/*
+===============================================================================
+SOURCE FILE:    MqClient.c
+                    Definition file for libmqclient.
+
+PROGRAM:        libmqclient
+
+FUNCTIONS:      MqClient* MqClientOpen(void)
+                void MqClientClose(MqClient* client)
+                long MqFetchAsync(MqClient* client, const char* path,
+                      int priority, MqFetchCallback callback, void* arg)
+                int MqFetch(MqClient* client, const char* path,
+                      int priority, MqFetchCallback callback, void* arg)
+                int MqClientEventFd(MqClient* client)
+                int MqClientDispatch(MqClient* client)
+                static size_t ReplyLimit(int queue)
+                static void UnlinkRequest(MqClient* client, MqRequest* req)
+                static long StartRequest(MqClient* client, const char* path,
+                      int priority, MqFetchCallback callback, void* arg,
+                      MqRequest** waited)
+                static void EndRequest(MqClient* client, MqRequest* req)
+                static int RunCallbacks(MqClient* client, MqRequest* req)
+                static void MarkReady(MqClient* client, MqRequest* req)
+                static void* ReadReplies(void* handle)
+
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER:     agent
+
+NOTES:
+The reader thread only ever receives and files the replies, the callbacks
+are run by whoever waits for or dispatches the request. One lock guards the
+whole handle, it is never held while a callback runs.
+
+Utilities.c is not linked in, its globals would end up in every program
+using the library, so the little it does for the queues is repeated here.
+===============================================================================
+*/
+
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include "Utilities.h"
+#include "MqClient.h"
+
+/* A reply received for a request, not yet given to its callback. */
+typedef struct MqReply
+{
+    struct MqReply* next;
+    Mesg* msg;
+} MqReply;
+
+/* A request in flight. */
+typedef struct MqRequest
+{
+    struct MqRequest* next;         // Requests of the handle in flight
+    struct MqRequest* nextReady;    // Requests with replies to dispatch
+    long id;                        // mesg_id of the request and replies
+    MqFetchCallback callback;
+    void* arg;
+    MqReply* first;                 // Replies waiting, oldest first
+    MqReply** last;
+    int sync;                       // Waited on by Mq Fetch, not dispatched
+    int ready;                      // On the ready list of the handle
+    int finished;                   // No more replies will arrive
+    int status;                     // 0 when the Server finished the file
+} MqRequest;
+
+struct MqClient
+{
+    int server;                     // The Server's SysV queue
+    int replies;                    // Private queue the replies arrive on
+    int event;                      // Readable while requests are ready
+    size_t messageData;             // Largest mesg_data of a reply
+    pid_t pid;
+    long lastId;
+    int closed;                     // The reply queue is gone
+    int closing;                    // Mq Client Close has been called
+    size_t pending;                 // Replies waiting for the callbacks of
+                                    // asynchronous requests
+    int waiting;                    // Mq Fetch calls in flight
+    MqRequest* requests;
+    MqRequest* ready;
+    MqRequest** readyLast;
+    pthread_t reader;
+    pthread_mutex_t lock;
+    pthread_mutex_t dispatching;    // Held by the one thread dispatching
+    pthread_cond_t change;          // A reply was filed or taken
+};
+
+/* Same as Queue Message Limit, the Server sizes its replies this way. */
+static size_t ReplyLimit(int queue)
+{
+    struct msqid_ds info;
+    long limit = -1;
+    FILE* fp;
+
+    if((fp = fopen(MSGMAX_PATH, "r")) != NULL)
+    {
+        if(fscanf(fp, "%ld", &limit) != 1)
+            limit = -1;
+        fclose(fp);
+    }
+
+    if(msgctl(queue, IPC_STAT, &info) == 0 &&
+        (limit < 0 || (long)(info.msg_qbytes / MESG_QUEUE_DEPTH) < limit))
+    {
+        limit = info.msg_qbytes / MESG_QUEUE_DEPTH;
+    }
+
+    if(limit <= (long)MESGHEADER)
+    {
+        return MAXMESSAGEDATA;
+    }
+
+    return limit - MESGHEADER;
+}
+
+/* Puts the request on the ready list, the lock must be held. */
+static void MarkReady(MqClient* client, MqRequest* req)
+{
+    uint64_t one = 1;
+
+    if(req->sync)
+    {
+        pthread_cond_broadcast(&client->change);
+        return;
+    }
+
+    if(req->ready)
+        return;
+
+    req->ready = 1;
+    req->nextReady = NULL;
+    *client->readyLast = req;
+    client->readyLast = &req->nextReady;
+
+    if(write(client->event, &one, sizeof(one)) < 0)
+    {
+        // The counter is already huge, the loop will be woken anyway.
+    }
+}
+
+static void* ReadReplies(void* handle)
+{
+    MqClient* client = handle;
+    MqRequest* req;
+    MqReply* reply;
+    Mesg* rcv = NULL;
+    ssize_t n;
+
+    while(1)
+    {
+        if(rcv == NULL &&
+            (rcv = malloc(offsetof(Mesg, mesg_data) + client->messageData))
+            == NULL)
+            break;
+
+        n = msgrcv(client->replies, &rcv->mesg_type,
+            MESGSIZE(client->messageData), 0, MSG_NOERROR);
+        if(n < 0 && errno == EINTR)
+            continue;
+
+        // The queue was removed by Mq Client Close.
+        if(n < (ssize_t)MESGHEADER)
+            break;
+
+        // The stamp a traced chunk carries past its data is left alone.
+        if(rcv->mesg_len > n - MESGHEADER)
+            rcv->mesg_len = n - MESGHEADER;
+
+        pthread_mutex_lock(&client->lock);
+        for(req = client->requests; req != NULL; req = req->next)
+        {
+            if(req->id == rcv->mesg_id && !req->finished)
+                break;
+        }
+
+        if(req == NULL)
+        {
+            pthread_mutex_unlock(&client->lock);
+            continue;
+        }
+
+        if(rcv->mesg_len == 0)
+        {
+            req->finished = 1;
+            MarkReady(client, req);
+            pthread_mutex_unlock(&client->lock);
+            continue;
+        }
+
+        // Hold off the Server while the callbacks fall behind, unless a
+        // waiting fetch needs a reply from further down the queue.
+        while(!req->sync && client->pending >= MQCLIENT_PENDING &&
+            client->waiting == 0 && !client->closing)
+        {
+            pthread_cond_wait(&client->change, &client->lock);
+        }
+
+        if((reply = malloc(sizeof(MqReply))) != NULL)
+        {
+            reply->msg = rcv;
+            reply->next = NULL;
+            *req->last = reply;
+            req->last = &reply->next;
+            if(!req->sync)
+                client->pending++;
+            rcv = NULL;
+            MarkReady(client, req);
+        }
+        pthread_mutex_unlock(&client->lock);
+    }
+
+    free(rcv);
+
+    // Nothing more will arrive, end every request still in flight.
+    pthread_mutex_lock(&client->lock);
+    client->closed = 1;
+    for(req = client->requests; req != NULL; req = req->next)
+    {
+        if(req->finished)
+            continue;
+
+        req->finished = 1;
+        req->status = -1;
+        MarkReady(client, req);
+    }
+    pthread_cond_broadcast(&client->change);
+    pthread_mutex_unlock(&client->lock);
+
+    return 0;
+}
+
+/* Takes the request off of the handle's lists, the lock must be held. */
+static void UnlinkRequest(MqClient* client, MqRequest* req)
+{
+    MqRequest** link;
+
+    for(link = &client->requests; *link != req; link = &(*link)->next)
+    {
+    }
+    *link = req->next;
+
+    if(req->sync)
+        client->waiting--;
+
+    // Filed again by the reader while its last callbacks were running.
+    if(req->ready)
+    {
+        for(link = &client->ready; *link != req; link = &(*link)->nextReady)
+        {
+        }
+        *link = req->nextReady;
+        if(client->readyLast == &req->nextReady)
+            client->readyLast = link;
+    }
+}
+
+/*
+Files and sends a request, returning its id or -1. An asynchronous request
+may be over and freed by the time this returns, only a waited one is handed
+back through waited.
+*/
+static long StartRequest(MqClient* client, const char* path, int priority,
+                         MqFetchCallback callback, void* arg,
+                         MqRequest** waited)
+{
+    MqRequest* req;
+    Mesg* snd;
+    size_t len = strlen(path);
+    long id;
+
+    // The Server reads the name with "%s" into BUFF bytes.
+    if(len == 0 || len >= BUFF || strpbrk(path, " \t\n") != NULL)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if(priority < 1)
+        priority = 1;
+    else if(priority > 1000)
+        priority = 1000;
+
+    if((req = calloc(1, sizeof(MqRequest))) == NULL)
+    {
+        return -1;
+    }
+
+    if((snd = malloc(offsetof(Mesg, mesg_data) + BUFF + 32)) == NULL)
+    {
+        free(req);
+        return -1;
+    }
+
+    req->callback = callback;
+    req->arg = arg;
+    req->sync = (waited != NULL);
+    req->last = &req->first;
+
+    // Filed before sending, the first reply may beat msgsnd back.
+    pthread_mutex_lock(&client->lock);
+    if(client->closed)
+    {
+        pthread_mutex_unlock(&client->lock);
+        free(snd);
+        free(req);
+        errno = EIDRM;
+        return -1;
+    }
+
+    id = req->id = ++client->lastId;
+    req->next = client->requests;
+    client->requests = req;
+
+    // A reader holding off for the callbacks must read on for this one.
+    if(req->sync)
+    {
+        client->waiting++;
+        pthread_cond_broadcast(&client->change);
+    }
+    pthread_mutex_unlock(&client->lock);
+
+    if(waited != NULL)
+        *waited = req;
+
+    snd->mesg_type = CLIENT_TO_SERVER;
+    snd->mesg_id = id;
+    snd->mesg_len = sprintf(snd->mesg_data, "%s %d %d queue=%d", path,
+        priority, (int)client->pid, client->replies);
+
+    if(msgsnd(client->server, &snd->mesg_type, MESGSIZE(snd->mesg_len), 0)
+        < 0)
+    {
+        free(snd);
+
+        pthread_mutex_lock(&client->lock);
+        UnlinkRequest(client, req);
+        pthread_mutex_unlock(&client->lock);
+
+        free(req);
+        return -1;
+    }
+
+    free(snd);
+    return id;
+}
+
+/* Forgets a finished request whose replies have all been handed out. */
+static void EndRequest(MqClient* client, MqRequest* req)
+{
+    pthread_mutex_lock(&client->lock);
+    UnlinkRequest(client, req);
+    pthread_mutex_unlock(&client->lock);
+
+    free(req);
+}
+
+/*
+Hands the waiting replies of one request to its callback. Returns the
+number of calls made, -1 in place of 0 when the request is over.
+*/
+static int RunCallbacks(MqClient* client, MqRequest* req)
+{
+    MqReply* reply;
+    MqReply* next;
+    size_t taken = 0;
+    int finished;
+    int calls = 0;
+
+    pthread_mutex_lock(&client->lock);
+    reply = req->first;
+    req->first = NULL;
+    req->last = &req->first;
+    finished = req->finished;
+
+    for(next = reply; next != NULL; next = next->next)
+    {
+        taken++;
+    }
+    if(taken > 0 && !req->sync)
+    {
+        client->pending -= taken;
+        pthread_cond_broadcast(&client->change);
+    }
+    pthread_mutex_unlock(&client->lock);
+
+    while(reply != NULL)
+    {
+        next = reply->next;
+        req->callback(req->arg, req->id, reply->msg->mesg_data,
+            reply->msg->mesg_len, 0);
+        calls++;
+
+        free(reply->msg);
+        free(reply);
+        reply = next;
+    }
+
+    // Replies filed after the lock was let go are picked up next time.
+    if(!finished)
+        return calls;
+
+    req->callback(req->arg, req->id, NULL, 0, req->status);
+    return -(calls + 1);
+}
+
+MqClient* MqClientOpen(void)
+{
+    MqClient* client;
+    key_t key;
+    int error;
+
+    if((client = calloc(1, sizeof(MqClient))) == NULL)
+    {
+        return NULL;
+    }
+
+    client->pid = getpid();
+    client->readyLast = &client->ready;
+    client->replies = -1;
+    client->event = -1;
+
+    key = ftok(MSGKEY_PATH, MSGKEY_ID);
+    if((client->server = msgget(key, MSGPERM | IPC_CREAT)) < 0 ||
+        (client->replies = msgget(IPC_PRIVATE, MSGPERM | IPC_CREAT)) < 0 ||
+        (client->event = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0)
+    {
+        error = errno;
+        if(client->replies >= 0)
+            msgctl(client->replies, IPC_RMID, NULL);
+        free(client);
+        errno = error;
+        return NULL;
+    }
+
+    client->messageData = ReplyLimit(client->server);
+
+    pthread_mutex_init(&client->lock, NULL);
+    pthread_mutex_init(&client->dispatching, NULL);
+    pthread_cond_init(&client->change, NULL);
+
+    if((error = pthread_create(&client->reader, NULL, ReadReplies,
+        client)) != 0)
+    {
+        msgctl(client->replies, IPC_RMID, NULL);
+        close(client->event);
+        pthread_cond_destroy(&client->change);
+        pthread_mutex_destroy(&client->dispatching);
+        pthread_mutex_destroy(&client->lock);
+        free(client);
+        errno = error;
+        return NULL;
+    }
+
+    return client;
+}
+
+void MqClientClose(MqClient* client)
+{
+    pthread_mutex_lock(&client->lock);
+    client->closing = 1;
+    pthread_cond_broadcast(&client->change);
+    pthread_mutex_unlock(&client->lock);
+
+    // Wakes the reader, which ends whatever is still in flight.
+    msgctl(client->replies, IPC_RMID, NULL);
+    pthread_join(client->reader, NULL);
+
+    while(MqClientDispatch(client) > 0)
+    {
+    }
+
+    close(client->event);
+    pthread_cond_destroy(&client->change);
+    pthread_mutex_destroy(&client->dispatching);
+    pthread_mutex_destroy(&client->lock);
+    free(client);
+}
+
+long MqFetchAsync(MqClient* client, const char* path, int priority,
+                  MqFetchCallback callback, void* arg)
+{
+    return StartRequest(client, path, priority, callback, arg, NULL);
+}
+
+int MqFetch(MqClient* client, const char* path, int priority,
+            MqFetchCallback callback, void* arg)
+{
+    MqRequest* req;
+    int status;
+
+    if(StartRequest(client, path, priority, callback, arg, &req) < 0)
+    {
+        return -1;
+    }
+
+    while(1)
+    {
+        pthread_mutex_lock(&client->lock);
+        while(req->first == NULL && !req->finished)
+        {
+            pthread_cond_wait(&client->change, &client->lock);
+        }
+        pthread_mutex_unlock(&client->lock);
+
+        if(RunCallbacks(client, req) < 0)
+            break;
+    }
+
+    status = req->status;
+    EndRequest(client, req);
+
+    return status;
+}
+
+int MqClientEventFd(MqClient* client)
+{
+    return client->event;
+}
+
+int MqClientDispatch(MqClient* client)
+{
+    MqRequest* req;
+    uint64_t count;
+    int calls = 0;
+    int n;
+
+    pthread_mutex_lock(&client->dispatching);
+
+    // Cleared first, anything filed from here on writes to it again.
+    if(read(client->event, &count, sizeof(count)) < 0)
+    {
+        // Nothing was signalled, the ready list may still hold requests.
+    }
+
+    while(1)
+    {
+        pthread_mutex_lock(&client->lock);
+        if((req = client->ready) != NULL)
+        {
+            client->ready = req->nextReady;
+            if(client->ready == NULL)
+                client->readyLast = &client->ready;
+            req->ready = 0;
+        }
+        pthread_mutex_unlock(&client->lock);
+
+        if(req == NULL)
+            break;
+
+        if((n = RunCallbacks(client, req)) < 0)
+        {
+            calls -= n;
+            EndRequest(client, req);
+        }
+        else
+        {
+            calls += n;
+        }
+    }
+
+    pthread_mutex_unlock(&client->dispatching);
+    return calls;
+}
@@ -0,0 +1,221 @@
+/*
+===============================================================================
+SOURCE FILE:    MqClient.h
+                    Header file for libmqclient, the Client as a library.
+
+PROGRAM:        libmqclient
+
+FUNCTIONS:      MqClient* MqClientOpen(void)
+                void MqClientClose(MqClient* client)
+                long MqFetchAsync(MqClient* client, const char* path,
+                      int priority, MqFetchCallback callback, void* arg)
+                int MqFetch(MqClient* client, const char* path,
+                      int priority, MqFetchCallback callback, void* arg)
+                int MqClientEventFd(MqClient* client)
+                int MqClientDispatch(MqClient* client)
+
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER:     agent
+
+NOTES:
+Lets a long running program fetch files from the Server without starting a
+Client process for each one. Everything lives inside of the MqClient handle,
+the library has no global state and a program may open as many handles as
+it likes.
+
+Each handle owns a private SysV reply queue (see Client -q) and a thread
+reading from it, so replies never mix with those of another handle or of
+another process. The requests of a handle are told apart by their mesg_id,
+any number of them may be in flight at once.
+
+A fetch is either waited for with Mq Fetch or started with Mq Fetch Async.
+The replies of asynchronous fetches are handed to their callbacks by Mq
+Client Dispatch, which is meant to be called by an event loop whenever the
+descriptor from Mq Client Event Fd becomes readable. SysV queues cannot be
+polled, the eventfd stands in for the queue.
+
+Every function may be called from any thread. Callbacks run in the thread
+which called Mq Fetch or Mq Client Dispatch and may start new fetches.
+
+Link with -lmqclient -pthread. The Server must be running from the same
+directory, the queue key is made from its Info directory.
+===============================================================================
+*/
+
+#ifndef MQCLIENT_H
+#define MQCLIENT_H
+
+#include <stddef.h>
+
+#define MQCLIENT_PENDING    64  // Async replies held for the callbacks
+
+typedef struct MqClient MqClient;
+
+/*
+Called once for every chunk of the file, data and len being the chunk, then
+a last time with a NULL data to say the fetch is over. The status of that
+last call is 0 when the Server finished the file and -1 when the handle
+stopped before it did. A file the Server cannot open arrives as the text
+"Cannot open file: path" like it does for the Client.
+*/
+typedef void (*MqFetchCallback)(void* arg, long request, const char* data,
+                                size_t len, int status);
+
+/*
+===============================================================================
+FUNCTION:       Mq Client Open
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      MqClient* MqClientOpen(void)
+
+PARAMETERS:     void
+
+RETURNS:        -Returns NULL with errno set when the Server's queue, the
+                    reply queue, the eventfd or the thread cannot be made.
+                -Returns the new handle otherwise.
+===============================================================================
+*/
+MqClient* MqClientOpen(void);
+
+/*
+===============================================================================
+FUNCTION:       Mq Client Close
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void MqClientClose(MqClient* client)
+
+PARAMETERS:     MqClient* client
+                    The handle, freed before this returns.
+
+RETURNS:        void
+
+NOTES:
+Removes the reply queue, which also stops the Server sending to it. The
+asynchronous fetches still in flight have their callbacks called a last
+time with a status of -1. No other thread may be using the handle.
+===============================================================================
+*/
+void MqClientClose(MqClient* client);
+
+/*
+===============================================================================
+FUNCTION:       Mq Fetch Async
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      long MqFetchAsync(MqClient* client, const char* path,
+                      int priority, MqFetchCallback callback, void* arg)
+
+PARAMETERS:     MqClient* client
+                    The handle.
+                const char* path
+                    The file to fetch, without any whitespace.
+                int priority
+                    1 to 1000, as for the Client.
+                MqFetchCallback callback
+                    Given the replies by Mq Client Dispatch.
+                void* arg
+                    Passed along to the callback.
+
+RETURNS:        -Returns -1 with errno set if the request cannot be sent.
+                -Returns the id of the request, also given to the callback.
+===============================================================================
+*/
+long MqFetchAsync(MqClient* client, const char* path, int priority,
+                  MqFetchCallback callback, void* arg);
+
+/*
+===============================================================================
+FUNCTION:       Mq Fetch
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int MqFetch(MqClient* client, const char* path,
+                      int priority, MqFetchCallback callback, void* arg)
+
+PARAMETERS:     Same as Mq Fetch Async.
+
+RETURNS:        -Returns -1 if the request cannot be sent or the handle
+                    stopped before the file was finished.
+                -Returns 0 once the whole file was given to the callback.
+
+NOTES:
+Waits for the fetch in the calling thread, which runs the callback. Other
+threads may fetch or dispatch on the same handle meanwhile. Only the replies
+held for asynchronous fetches count against MQCLIENT_PENDING, and the reader
+never holds off while a waiting fetch is in flight, so a fetch waited on
+with MQCLIENT_PENDING replies undispatched still finishes. Those asynchronous
+replies keep being filed meanwhile, beyond MQCLIENT_PENDING.
+===============================================================================
+*/
+int MqFetch(MqClient* client, const char* path, int priority,
+            MqFetchCallback callback, void* arg);
+
+/*
+===============================================================================
+FUNCTION:       Mq Client Event Fd
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int MqClientEventFd(MqClient* client)
+
+PARAMETERS:     MqClient* client
+                    The handle.
+
+RETURNS:        A non-blocking eventfd, readable while asynchronous fetches
+                have replies waiting. It belongs to the handle.
+===============================================================================
+*/
+int MqClientEventFd(MqClient* client);
+
+/*
+===============================================================================
+FUNCTION:       Mq Client Dispatch
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int MqClientDispatch(MqClient* client)
+
+PARAMETERS:     MqClient* client
+                    The handle.
+
+RETURNS:        The number of callbacks called, 0 when nothing was waiting.
+
+NOTES:
+Never blocks on the queue. One thread dispatches at a time, a callback must
+not call Mq Client Dispatch itself.
+===============================================================================
+*/
+int MqClientDispatch(MqClient* client);
+
+#endif
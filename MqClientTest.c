@@ -0,0 +1,217 @@
+/*
+===============================================================================
+SOURCE FILE:    MqClientTest.c
+                    Stress test of libmqclient, built by "make test" under
+                    AddressSanitizer and ThreadSanitizer.
+
+PROGRAM:        MqClientTest
+
+FUNCTIONS:      int main(int argc, char** argv)
+                static void* Submit(void* arg)
+                static void* Dispatch(void* arg)
+                static void Count(void* arg, long request, const char* data,
+                                  size_t len, int status)
+                static void CountAsync(void* arg, long request,
+                                       const char* data, size_t len,
+                                       int status)
+
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER:     agent
+
+NOTES:
+A Server must be running from this directory. TEST_THREADS threads start
+TEST_FETCHES asynchronous fetches each and one more waits on a fetch of its
+own now and then, all on one handle, while a single thread dispatches. Many
+requests finish while their callbacks are still running, which is where a
+request freed while still on the ready list would show up.
+
+Before the dispatcher starts, TEST_HELD asynchronous fetches are left with
+more than MQCLIENT_PENDING replies undispatched while a fetch is waited on,
+which must still finish rather than wait behind them.
+
+The file fetched is made for the run and removed afterwards. Every fetch
+must end exactly once with a status of 0 and the whole file. Exits with 1
+otherwise.
+===============================================================================
+*/
+
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "MqClient.h"
+
+#define TEST_THREADS    4       // Threads starting asynchronous fetches
+#define TEST_FETCHES    64      // Asynchronous fetches per thread
+#define TEST_HELD       8       // Fetches undispatched during a waited one
+#define TEST_FILE       "MqClientTest.dat"
+#define TEST_SIZE       32768   // Bytes of the file, a few dozen chunks
+
+/* One fetch, filled in by its callback. */
+typedef struct
+{
+    size_t bytes;
+    int ends;                   // Times the fetch was said to be over
+    int status;
+} Fetch;
+
+static MqClient* client;
+static Fetch fetches[TEST_THREADS + 1][TEST_FETCHES];
+static Fetch held[TEST_HELD + 1];
+static atomic_int finished;     // Asynchronous fetches over, or not started
+
+/* Adds up the chunks of a fetch and notes how it ended. */
+static void Count(void* arg, long request, const char* data, size_t len,
+                  int status)
+{
+    Fetch* fetch = arg;
+
+    (void)request;
+
+    if(data != NULL)
+    {
+        fetch->bytes += len;
+        return;
+    }
+
+    fetch->ends++;
+    fetch->status = status;
+}
+
+/* Count for the asynchronous fetches, which the dispatcher waits on. */
+static void CountAsync(void* arg, long request, const char* data, size_t len,
+                       int status)
+{
+    Count(arg, request, data, len, status);
+
+    if(data == NULL)
+        atomic_fetch_add(&finished, 1);
+}
+
+/* Starts the fetches of one thread, priorities mixed so the chunks differ. */
+static void* Submit(void* arg)
+{
+    Fetch* mine = arg;
+    int i;
+
+    for(i = 0; i < TEST_FETCHES; i++)
+    {
+        if(MqFetchAsync(client, TEST_FILE, 1 + (i % 4) * 3, CountAsync,
+            &mine[i]) < 0)
+        {
+            perror("MqFetchAsync");
+            atomic_fetch_add(&finished, 1);
+        }
+    }
+
+    return NULL;
+}
+
+/* The event loop: dispatches until every asynchronous fetch is over. */
+static void* Dispatch(void* arg)
+{
+    struct pollfd pfd;
+
+    (void)arg;
+
+    pfd.fd = MqClientEventFd(client);
+    pfd.events = POLLIN;
+
+    while(atomic_load(&finished) < TEST_THREADS * TEST_FETCHES + TEST_HELD)
+    {
+        poll(&pfd, 1, 100);
+        MqClientDispatch(client);
+    }
+
+    return NULL;
+}
+
+int main(int argc, char** argv)
+{
+    pthread_t submitters[TEST_THREADS];
+    pthread_t dispatcher;
+    char block[TEST_SIZE];
+    Fetch* fetch;
+    FILE* fp;
+    int errors = 0;
+    int i;
+    int j;
+
+    (void)argc;
+    (void)argv;
+
+    memset(block, 'm', sizeof(block));
+    if((fp = fopen(TEST_FILE, "w")) == NULL ||
+        fwrite(block, sizeof(char), sizeof(block), fp) != sizeof(block) ||
+        fclose(fp) != 0 || (client = MqClientOpen()) == NULL)
+    {
+        perror("MqClientTest");
+        unlink(TEST_FILE);
+        return 1;
+    }
+
+    // Nothing dispatches these yet, so their replies pile up.
+    for(j = 0; j < TEST_HELD; j++)
+    {
+        if(MqFetchAsync(client, TEST_FILE, 10, CountAsync, &held[j]) < 0)
+        {
+            perror("MqFetchAsync");
+            atomic_fetch_add(&finished, 1);
+        }
+    }
+    if(MqFetch(client, TEST_FILE, 10, Count, &held[TEST_HELD]) < 0)
+        errors++;
+
+    pthread_create(&dispatcher, NULL, Dispatch, NULL);
+    for(i = 0; i < TEST_THREADS; i++)
+    {
+        pthread_create(&submitters[i], NULL, Submit, fetches[i]);
+    }
+
+    // Waited fetches share the handle with the asynchronous ones.
+    for(j = 0; j < TEST_FETCHES / 8; j++)
+    {
+        fetch = &fetches[TEST_THREADS][j];
+        if(MqFetch(client, TEST_FILE, 10, Count, fetch) < 0)
+            errors++;
+    }
+
+    for(i = 0; i < TEST_THREADS; i++)
+    {
+        pthread_join(submitters[i], NULL);
+    }
+    pthread_join(dispatcher, NULL);
+
+    MqClientClose(client);
+    unlink(TEST_FILE);
+
+    for(i = 0; i <= TEST_THREADS; i++)
+    {
+        for(j = 0; j < ((i < TEST_THREADS) ? TEST_FETCHES : TEST_FETCHES / 8);
+            j++)
+        {
+            fetch = &fetches[i][j];
+            if(fetch->ends != 1 || fetch->status != 0 ||
+                fetch->bytes != TEST_SIZE)
+                errors++;
+        }
+    }
+    for(j = 0; j <= TEST_HELD; j++)
+    {
+        if(held[j].ends != 1 || held[j].status != 0 ||
+            held[j].bytes != TEST_SIZE)
+            errors++;
+    }
+
+    printf("MqClientTest: %d of %d fetches wrong.\n", errors,
+        TEST_THREADS * TEST_FETCHES + TEST_FETCHES / 8 + TEST_HELD + 1);
+
+    return errors ? 1 : 0;
+}
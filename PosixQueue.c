@@ -0,0 +1,204 @@
+/*
+===============================================================================
+SOURCE FILE:    PosixQueue.c
+                    Definition file for the POSIX message queue backend.
+
+PROGRAM:        Client / Server
+
+FUNCTIONS:      mqd_t OpenPosixQueue(const char* name, int flags, long maxmsg)
+                mqd_t OpenClientPosixQueue(pid_t client, int flags,
+                                           long maxmsg)
+                int SendPosixMessage(mqd_t queue, Mesg* msg,
+                                     unsigned int priority)
+                int ReadPosixMessage(mqd_t queue, Mesg* msg)
+                int ReadPosixMessageNoWait(mqd_t queue, Mesg* msg)
+                unsigned int PosixPriority(int priority)
+                void ClientPosixQueueName(char* name, pid_t client)
+                size_t PosixMessageLimit(void)
+                int PosixQueueLength(mqd_t queue)
+                int RaisePosixQueueLimit(void)
+                long PosixQueuesFit(long maxmsg)
+                static int ReceivePosixMessage(mqd_t queue, Mesg* msg,
+                                    const struct timespec* timeout)
+
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER:     agent
+
+NOTES:
+The messages are placed on the POSIX queue starting right after the
+mesg_type, identical to the layout used with msgsnd.
+===============================================================================
+*/
+
+#include "PosixQueue.h"
+
+mqd_t OpenPosixQueue(const char* name, int flags, long maxmsg)
+{
+    struct mq_attr attr;
+    mqd_t queue;
+
+    if(!(flags & O_CREAT))
+    {
+        return mq_open(name, flags);
+    }
+
+    memset(&attr, 0, sizeof(attr));
+    attr.mq_maxmsg = (maxmsg > 0) ? maxmsg : MQ_DEFAULT_MAXMSG;
+    attr.mq_msgsize = MESGSIZE(messageData);
+
+    // Over RLIMIT_MSGQUEUE, a shorter queue still works at the same size.
+    while((queue = mq_open(name, flags, MSGPERM, &attr)) == (mqd_t)-1 &&
+        (errno == EMFILE || errno == ENOMEM))
+    {
+        if(RaisePosixQueueLimit() == 0)
+            continue;
+
+        if(attr.mq_maxmsg <= 1)
+            break;
+
+        attr.mq_maxmsg /= 2;
+    }
+
+    return queue;
+}
+
+mqd_t OpenClientPosixQueue(pid_t client, int flags, long maxmsg)
+{
+    char name[MQ_NAME_SIZE];
+
+    ClientPosixQueueName(name, client);
+
+    return OpenPosixQueue(name, flags, maxmsg);
+}
+
+int SendPosixMessage(mqd_t queue, Mesg* msg, unsigned int priority)
+{
+    if(mq_send(queue, (char*)&msg->mesg_id, StampMessage(msg), priority) < 0)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Shared by Read Posix Message and Read Posix Message No Wait. */
+static int ReceivePosixMessage(mqd_t queue, Mesg* msg,
+                               const struct timespec* timeout)
+{
+    ssize_t n;
+
+    if(timeout == NULL)
+    {
+        n = mq_receive(queue, (char*)&msg->mesg_id, MESGSIZE(messageData),
+            NULL);
+    }
+    else
+    {
+        n = mq_timedreceive(queue, (char*)&msg->mesg_id,
+            MESGSIZE(messageData), NULL, timeout);
+    }
+
+    return ReceivedMessage(msg, n);
+}
+
+int ReadPosixMessage(mqd_t queue, Mesg* msg)
+{
+    return ReceivePosixMessage(queue, msg, NULL);
+}
+
+int ReadPosixMessageNoWait(mqd_t queue, Mesg* msg)
+{
+    // A deadline that has already passed makes the receive return at once.
+    struct timespec past = { 0, 0 };
+
+    return ReceivePosixMessage(queue, msg, &past);
+}
+
+unsigned int PosixPriority(int priority)
+{
+    if(priority < 1)
+    {
+        priority = 1;
+    }
+    else if(priority > 1000)
+    {
+        priority = 1000;
+    }
+
+    return (MQ_PRIORITIES - 1) - ((priority - 1) * (MQ_PRIORITIES - 1)) / 999;
+}
+
+void ClientPosixQueueName(char* name, pid_t client)
+{
+    snprintf(name, MQ_NAME_SIZE, CLIENT_MQ_NAME, (int)client);
+}
+
+size_t PosixMessageLimit(void)
+{
+    long limit;
+
+    if((limit = ReadSystemLimit(MQ_MSGSIZE_PATH)) <= (long)MESGHEADER)
+    {
+        return MAXMESSAGEDATA;
+    }
+
+    // Every queue is charged for all of its messages, see MQ_MSGSIZE.
+    if(limit > MQ_MSGSIZE)
+    {
+        limit = MQ_MSGSIZE;
+    }
+
+    return limit - MESGHEADER;
+}
+
+int PosixQueueLength(mqd_t queue)
+{
+    struct mq_attr attr;
+
+    if(mq_getattr(queue, &attr) < 0)
+    {
+        return -1;
+    }
+
+    return attr.mq_curmsgs;
+}
+
+int RaisePosixQueueLimit(void)
+{
+    struct rlimit limit;
+
+    if(getrlimit(RLIMIT_MSGQUEUE, &limit) < 0 ||
+        limit.rlim_cur >= limit.rlim_max)
+    {
+        return -1;
+    }
+
+    limit.rlim_cur = limit.rlim_max;
+    return setrlimit(RLIMIT_MSGQUEUE, &limit);
+}
+
+long PosixQueuesFit(long maxmsg)
+{
+    struct rlimit limit;
+    long queues;
+    long fit = -1;
+
+    if(getrlimit(RLIMIT_MSGQUEUE, &limit) == 0 &&
+        limit.rlim_cur != RLIM_INFINITY)
+    {
+        fit = limit.rlim_cur /
+            (maxmsg * (MESGSIZE(messageData) + MQ_MSG_OVERHEAD));
+    }
+
+    if((queues = ReadSystemLimit(MQ_QUEUES_PATH)) > 0 &&
+        (fit < 0 || queues < fit))
+    {
+        fit = queues;
+    }
+
+    return fit;
+}
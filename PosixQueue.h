@@ -0,0 +1,361 @@
+/*
+===============================================================================
+SOURCE FILE:    PosixQueue.h
+                    Header file for the POSIX message queue backend shared by
+                    the Client and Server programs.
+
+PROGRAM:        Client / Server
+
+FUNCTIONS:      mqd_t OpenPosixQueue(const char* name, int flags, long maxmsg)
+                mqd_t OpenClientPosixQueue(pid_t client, int flags,
+                                           long maxmsg)
+                int SendPosixMessage(mqd_t queue, Mesg* msg,
+                                     unsigned int priority)
+                int ReadPosixMessage(mqd_t queue, Mesg* msg)
+                int ReadPosixMessageNoWait(mqd_t queue, Mesg* msg)
+                unsigned int PosixPriority(int priority)
+                void ClientPosixQueueName(char* name, pid_t client)
+                size_t PosixMessageLimit(void)
+                int PosixQueueLength(mqd_t queue)
+                int RaisePosixQueueLimit(void)
+                long PosixQueuesFit(long maxmsg)
+
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER:     agent
+
+NOTES:
+An alternative to the single SysV message queue. The Server owns one well
+known request queue (SERVER_MQ_NAME) and every Client owns its own reply
+queue (CLIENT_MQ_NAME followed by its PID), so the message type is no longer
+needed to route replies.
+
+The messages keep the same layout as on the SysV queue: everything after the
+mesg_type is placed on the queue and only MESGSIZE(mesg_len) bytes are sent.
+The POSIX queues carry real priorities (0-31) which are derived from the
+Client's 1-1000 priority. On Linux a mqd_t is a file descriptor which can be
+watched by poll/epoll or mq_notify.
+
+The queues are created to hold messages with messageData bytes of data, which
+should first be set from Posix Message Limit.
+
+Every queue is charged in full (mq_maxmsg times mq_msgsize, plus a little)
+against the user's RLIMIT_MSGQUEUE, 819200 bytes by default. Messages are
+therefore kept to MQ_MSGSIZE rather than msgsize_max, so that about forty
+queues of the default ten messages fit instead of nine. Past that a queue is
+created with fewer messages, down to a single one, and once even that does
+not fit the Client says so and exits with 1. Before a queue is made shorter
+the soft limit is raised to the hard one, so "ulimit -Hq" (the msgqueue item
+of limits.conf) sets how many Clients can run at once. The system wide
+queues_max, 256 by default, is a second limit no user setting lifts.
+===============================================================================
+*/
+
+#ifndef POSIXQUEUE_H
+#define POSIXQUEUE_H
+
+#include <sys/resource.h>
+#include "Utilities.h"
+
+#define SERVER_MQ_NAME      "/mqserver"     // Request queue owned by Server
+#define CLIENT_MQ_NAME      "/mqclient.%d"  // Reply queue owned by a Client
+#define MQ_NAME_SIZE        64              // Size of a queue name buffer
+#define MQ_PRIORITIES       32              // Priorities guaranteed by POSIX
+#define MQ_DEFAULT_MAXMSG   10              // Default /proc/sys/fs/mqueue/msg_max
+#define MQ_MSGSIZE_PATH     "/proc/sys/fs/mqueue/msgsize_max"
+#define MQ_MSGSIZE          2048            // Largest message of a queue
+#define MQ_QUEUES_PATH      "/proc/sys/fs/mqueue/queues_max"
+#define MQ_MSG_OVERHEAD     104             // Bytes charged per message on
+                                            // top of its data
+
+/*
+===============================================================================
+FUNCTION:       Open Posix Queue
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      mqd_t OpenPosixQueue(const char* name, int flags, long maxmsg)
+
+PARAMETERS:     const char* name
+                    Name of the queue, beginning with a '/'.
+                int flags
+                    The mq_open flags (O_RDONLY, O_WRONLY, O_CREAT, ...).
+                long maxmsg
+                    Number of messages the queue may hold when it is created.
+                    Ignored when O_CREAT is not given.
+
+RETURNS:        -Returns (mqd_t)-1 on failure to open or create the queue.
+                -Returns the queue descriptor on success.
+
+NOTES:
+Creates or opens a POSIX message queue. Created queues hold messages of up to
+MESGSIZE(messageData) bytes. When RLIMIT_MSGQUEUE has no room for maxmsg
+messages (EMFILE or ENOMEM) the queue is created with half as many until it
+fits, the message size never changes since both sides rely on it.
+===============================================================================
+*/
+mqd_t OpenPosixQueue(const char* name, int flags, long maxmsg);
+
+/*
+===============================================================================
+FUNCTION:       Open Client Posix Queue
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      mqd_t OpenClientPosixQueue(pid_t client, int flags,
+                                           long maxmsg)
+
+PARAMETERS:     pid_t client
+                    PID of the Client which owns the reply queue.
+                int flags
+                    The mq_open flags.
+                long maxmsg
+                    Number of messages the queue may hold when it is created.
+
+RETURNS:        -Returns (mqd_t)-1 on failure to open or create the queue.
+                -Returns the queue descriptor on success.
+
+NOTES:
+Wrapper of Open Posix Queue that builds the reply queue name of a Client.
+===============================================================================
+*/
+mqd_t OpenClientPosixQueue(pid_t client, int flags, long maxmsg);
+
+/*
+===============================================================================
+FUNCTION:       Send Posix Message
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int SendPosixMessage(mqd_t queue, Mesg* msg,
+                                     unsigned int priority)
+
+PARAMETERS:     mqd_t queue
+                    Destination queue.
+                Mesg* msg
+                    Message to send, the mesg_len must be filled in. The
+                    mesg_type is ignored.
+                unsigned int priority
+                    POSIX priority of the message (0-31).
+
+RETURNS:        -Returns -1 on failure to send a message.
+                -Returns 0 on success.
+
+NOTES:
+Blocks while the queue is full unless the queue was opened with O_NONBLOCK,
+in which case -1 is returned with errno set to EAGAIN. Stamps traced chunks
+like Send Message.
+===============================================================================
+*/
+int SendPosixMessage(mqd_t queue, Mesg* msg, unsigned int priority);
+
+/*
+===============================================================================
+FUNCTION:       Read Posix Message
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int ReadPosixMessage(mqd_t queue, Mesg* msg)
+
+PARAMETERS:     mqd_t queue
+                    Source queue.
+                Mesg* msg
+                    Destination message structure.
+
+RETURNS:        -Returns -1 on failure to read a message.
+                -Returns 0 on received message success.
+
+NOTES:
+Reads the highest priority message from the queue. As with Read Message, the
+mesg_len is trimmed to the number of bytes received and the data is null
+terminated.
+===============================================================================
+*/
+int ReadPosixMessage(mqd_t queue, Mesg* msg);
+
+/*
+===============================================================================
+FUNCTION:       Read Posix Message No Wait
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int ReadPosixMessageNoWait(mqd_t queue, Mesg* msg)
+
+PARAMETERS:     mqd_t queue
+                    Source queue.
+                Mesg* msg
+                    Destination message structure.
+
+RETURNS:        -Returns -1 on failure to read a message, errno is ETIMEDOUT
+                when the queue is empty.
+                -Returns 0 on received message success.
+
+NOTES:
+Same as Read Posix Message but returns at once when the queue is empty, even
+on a queue opened without O_NONBLOCK.
+===============================================================================
+*/
+int ReadPosixMessageNoWait(mqd_t queue, Mesg* msg);
+
+/*
+===============================================================================
+FUNCTION:       Posix Priority
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      unsigned int PosixPriority(int priority)
+
+PARAMETERS:     int priority
+                    Client priority, 1 (most urgent) to 1000 (least urgent).
+
+RETURNS:        The POSIX priority, 31 (most urgent) to 0 (least urgent).
+
+NOTES:
+Maps the Client's priority onto the POSIX queue priorities.
+===============================================================================
+*/
+unsigned int PosixPriority(int priority);
+
+/*
+===============================================================================
+FUNCTION:       Client Posix Queue Name
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void ClientPosixQueueName(char* name, pid_t client)
+
+PARAMETERS:     char* name
+                    Buffer of at least MQ_NAME_SIZE characters.
+                pid_t client
+                    PID of the Client which owns the reply queue.
+
+RETURNS:        void
+
+NOTES:
+Fills in the name of a Client's reply queue.
+===============================================================================
+*/
+void ClientPosixQueueName(char* name, pid_t client);
+
+/*
+===============================================================================
+FUNCTION:       Posix Message Limit
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      size_t PosixMessageLimit(void)
+
+PARAMETERS:     void
+
+RETURNS:        The largest mesg_data a POSIX message may carry.
+
+NOTES:
+Reads the msgsize_max of the system, the largest message an unprivileged
+process may create a queue for, and keeps it to MQ_MSGSIZE. The Client and
+the Server both arrive at the same size. Falls back to MAXMESSAGEDATA when
+msgsize_max cannot be read.
+===============================================================================
+*/
+size_t PosixMessageLimit(void);
+
+/*
+===============================================================================
+FUNCTION:       Posix Queue Length
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int PosixQueueLength(mqd_t queue)
+
+PARAMETERS:     mqd_t queue
+                    The POSIX message queue.
+
+RETURNS:        -Returns -1 if the queue cannot be read.
+                -Returns the number of messages waiting on the queue.
+===============================================================================
+*/
+int PosixQueueLength(mqd_t queue);
+
+/*
+===============================================================================
+FUNCTION:       Raise Posix Queue Limit
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int RaisePosixQueueLimit(void)
+
+RETURNS:        -Returns -1 if RLIMIT_MSGQUEUE is already at its hard limit.
+                -Returns 0 once the soft limit has been raised to it.
+===============================================================================
+*/
+int RaisePosixQueueLimit(void);
+
+/*
+===============================================================================
+FUNCTION:       Posix Queues Fit
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      long PosixQueuesFit(long maxmsg)
+
+PARAMETERS:     long maxmsg
+                    Messages each queue holds.
+
+RETURNS:        -Returns -1 if there is no limit to go by.
+                -Returns how many queues of messageData bytes fit.
+
+NOTES:
+Counts what RLIMIT_MSGQUEUE of this process charges, MQ_MSG_OVERHEAD
+included, and caps it at queues_max. Every queue of the user is counted,
+the Server's own request queue as well.
+===============================================================================
+*/
+long PosixQueuesFit(long maxmsg);
+
+#endif
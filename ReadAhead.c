@@ -0,0 +1,263 @@
+/*
+===============================================================================
+SOURCE FILE:    ReadAhead.c
+                    Definition file for the Server's read-ahead thread.
+
+PROGRAM:        Server
+
+FUNCTIONS:      ReadAhead* StartReadAhead(struct FileSource* src,
+                                          size_t size, off_t limit)
+                Mesg* TakeAhead(ReadAhead* ahead, TraceRecord* record)
+                void ResizeAhead(ReadAhead* ahead, size_t size)
+                void StopReadAhead(ReadAhead* ahead)
+                static void* RunReader(void* arg)
+                static int WaitAhead(ReadAhead* ahead, int reader)
+                static void WakeAhead(ReadAhead* ahead, int reader)
+                static void FreeAhead(ReadAhead* ahead)
+
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER:     agent
+
+NOTES:
+The end of the file is a chunk of length 0. The head only moves once the
+sender gives its chunk back, so the reader never fills the chunk being sent.
+
+A side sets its waiting flag before it checks the counters one last time,
+and a side that has moved a counter checks the other's flag afterwards, so
+one of the two always sees the other.
+===============================================================================
+*/
+
+#include "Server.h"
+
+static void* RunReader(void* arg);
+static int WaitAhead(ReadAhead* ahead, int reader);
+static void WakeAhead(ReadAhead* ahead, int reader);
+static void FreeAhead(ReadAhead* ahead);
+
+ReadAhead* StartReadAhead(struct FileSource* src, size_t size, off_t limit)
+{
+    ReadAhead* ahead;
+    sigset_t block;
+    sigset_t old;
+    int i;
+
+    if((ahead = calloc(1, sizeof(ReadAhead))) == NULL)
+    {
+        return NULL;
+    }
+
+    for(i = 0; i < READAHEAD_SLOTS; i++)
+    {
+        if((ahead->slots[i] = CreateMessage()) == NULL)
+        {
+            FreeAhead(ahead);
+            return NULL;
+        }
+    }
+
+    ahead->src = src;
+    ahead->limit = limit;
+    atomic_init(&ahead->head, 0);
+    atomic_init(&ahead->tail, 0);
+    atomic_init(&ahead->size, size);
+    atomic_init(&ahead->stopping, 0);
+    atomic_init(&ahead->waiting[0], 0);
+    atomic_init(&ahead->waiting[1], 0);
+    pthread_mutex_init(&ahead->lock, NULL);
+    pthread_cond_init(&ahead->wake, NULL);
+
+    // The signals are for the thread sending the transfer.
+    sigemptyset(&block);
+    sigaddset(&block, SIGINT);
+    sigaddset(&block, SIGCHLD);
+    pthread_sigmask(SIG_BLOCK, &block, &old);
+
+    i = pthread_create(&ahead->reader, NULL, RunReader, ahead);
+
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    if(i != 0)
+    {
+        pthread_mutex_destroy(&ahead->lock);
+        pthread_cond_destroy(&ahead->wake);
+        FreeAhead(ahead);
+        return NULL;
+    }
+
+    return ahead;
+}
+
+Mesg* TakeAhead(ReadAhead* ahead, TraceRecord* record)
+{
+    unsigned long head = atomic_load_explicit(&ahead->head,
+        memory_order_relaxed);
+    Mesg* chunk;
+
+    // The chunk sent last goes back to the reader.
+    if(ahead->holding)
+    {
+        ahead->holding = 0;
+        atomic_store_explicit(&ahead->head, ++head, memory_order_seq_cst);
+        WakeAhead(ahead, 1);
+    }
+
+    if(WaitAhead(ahead, 0) < 0)
+    {
+        return NULL;
+    }
+
+    chunk = ahead->slots[head % READAHEAD_SLOTS];
+    if(chunk->mesg_len == 0)
+    {
+        return NULL;
+    }
+
+    if(record != NULL)
+    {
+        record->start = ahead->records[head % READAHEAD_SLOTS].start;
+        record->stage = ahead->records[head % READAHEAD_SLOTS].stage;
+    }
+
+    ahead->holding = 1;
+    return chunk;
+}
+
+void ResizeAhead(ReadAhead* ahead, size_t size)
+{
+    atomic_store_explicit(&ahead->size, size, memory_order_relaxed);
+}
+
+void StopReadAhead(ReadAhead* ahead)
+{
+    if(ahead == NULL)
+    {
+        return;
+    }
+
+    atomic_store(&ahead->stopping, 1);
+
+    pthread_mutex_lock(&ahead->lock);
+    pthread_cond_broadcast(&ahead->wake);
+    pthread_mutex_unlock(&ahead->lock);
+
+    pthread_join(ahead->reader, NULL);
+    pthread_mutex_destroy(&ahead->lock);
+    pthread_cond_destroy(&ahead->wake);
+
+    FreeAhead(ahead);
+}
+
+/* The reader thread: fills every free chunk, then the chunk ending the file. */
+static void* RunReader(void* arg)
+{
+    ReadAhead* ahead = arg;
+    TraceRecord* record;
+    Mesg* chunk;
+    unsigned long tail;
+    size_t want;
+    int done = 0;
+
+    while(!done)
+    {
+        if(WaitAhead(ahead, 1) < 0)
+            break;
+
+        tail = atomic_load_explicit(&ahead->tail, memory_order_relaxed);
+        chunk = ahead->slots[tail % READAHEAD_SLOTS];
+        record = &ahead->records[tail % READAHEAD_SLOTS];
+
+        want = atomic_load_explicit(&ahead->size, memory_order_relaxed);
+        if(ahead->limit >= 0 && (off_t)want > ahead->limit)
+            want = ahead->limit;
+
+        record->start = MonotonicNs();
+        chunk->mesg_len = (want > 0) ?
+            ReadChunk((FileSource*)ahead->src, chunk->mesg_data, want) : 0;
+
+        if(chunk->mesg_len == 0 && ahead->limit > 0)
+        {
+            // The file shrank after it was measured, keep to the framing.
+            memset(chunk->mesg_data, 0, want);
+            chunk->mesg_len = want;
+        }
+
+        if(ahead->limit > 0)
+            ahead->limit -= chunk->mesg_len;
+
+        record->stage = MonotonicNs() - record->start;
+        done = (chunk->mesg_len == 0);
+
+        atomic_store_explicit(&ahead->tail, tail + 1, memory_order_seq_cst);
+        WakeAhead(ahead, 0);
+    }
+
+    return NULL;
+}
+
+/*
+Waits until the reader has a free chunk to fill, or the sender a filled chunk
+to take. Returns -1 once the transfer is stopping.
+*/
+static int WaitAhead(ReadAhead* ahead, int reader)
+{
+    unsigned long head;
+    unsigned long tail;
+    int ready;
+
+    while(1)
+    {
+        head = atomic_load_explicit(&ahead->head, memory_order_seq_cst);
+        tail = atomic_load_explicit(&ahead->tail, memory_order_seq_cst);
+        ready = reader ? (tail - head < READAHEAD_SLOTS) : (tail != head);
+
+        if(atomic_load_explicit(&ahead->stopping, memory_order_relaxed))
+            return -1;
+
+        if(ready)
+            return 0;
+
+        pthread_mutex_lock(&ahead->lock);
+        atomic_store_explicit(&ahead->waiting[reader], 1,
+            memory_order_seq_cst);
+
+        head = atomic_load_explicit(&ahead->head, memory_order_seq_cst);
+        tail = atomic_load_explicit(&ahead->tail, memory_order_seq_cst);
+        ready = reader ? (tail - head < READAHEAD_SLOTS) : (tail != head);
+
+        if(!ready && !atomic_load(&ahead->stopping))
+            pthread_cond_wait(&ahead->wake, &ahead->lock);
+
+        atomic_store_explicit(&ahead->waiting[reader], 0,
+            memory_order_relaxed);
+        pthread_mutex_unlock(&ahead->lock);
+    }
+}
+
+/* Wakes the reader or the sender, only when it has gone to sleep. */
+static void WakeAhead(ReadAhead* ahead, int reader)
+{
+    if(atomic_load_explicit(&ahead->waiting[reader], memory_order_seq_cst))
+    {
+        pthread_mutex_lock(&ahead->lock);
+        pthread_cond_broadcast(&ahead->wake);
+        pthread_mutex_unlock(&ahead->lock);
+    }
+}
+
+/* Frees the chunks and the read ahead itself. */
+static void FreeAhead(ReadAhead* ahead)
+{
+    int i;
+
+    for(i = 0; i < READAHEAD_SLOTS; i++)
+    {
+        free(ahead->slots[i]);
+    }
+
+    free(ahead);
+}
@@ -0,0 +1,176 @@
+/*
+===============================================================================
+SOURCE FILE:    ReadAhead.h
+                    Header file for the Server's read-ahead thread.
+
+PROGRAM:        Server
+
+FUNCTIONS:      ReadAhead* StartReadAhead(struct FileSource* src,
+                                          size_t size, off_t limit)
+                Mesg* TakeAhead(ReadAhead* ahead, TraceRecord* record)
+                void ResizeAhead(ReadAhead* ahead, size_t size)
+                void StopReadAhead(ReadAhead* ahead)
+
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER:     agent
+
+NOTES:
+Splits a transfer in two: a reader thread fills chunks from the file while
+the transfer's own thread sends them. The two meet in a single-producer/
+single-consumer ring of READAHEAD_SLOTS messages allocated up front, so the
+chunks are read straight into the messages that are sent and the sender
+only waits on the disk when the reader has fallen behind.
+
+As with the shared memory ring the head and tail are free running counters
+and nothing is locked while both sides keep going. Only a side that has to
+sleep (the reader on a full ring, the sender on an empty one) sets its
+waiting flag and sleeps on a condition variable, which works with plain
+pthreads on any system.
+===============================================================================
+*/
+
+#ifndef READAHEAD_H
+#define READAHEAD_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include "Utilities.h"
+#include "Trace.h"
+
+#define READAHEAD_SLOTS 4       // Chunks the reader may be ahead of the sender
+
+struct FileSource;
+
+/* The ring of chunks between the reader and the sender. */
+typedef struct ReadAhead
+{
+    struct FileSource* src;
+    pthread_t reader;
+    Mesg* slots[READAHEAD_SLOTS];
+    TraceRecord records[READAHEAD_SLOTS];   // When each chunk was read
+    atomic_ulong head;          // Chunks given back by the sender
+    atomic_ulong tail;          // Chunks filled by the reader
+    atomic_size_t size;         // Bytes the sender wants in a chunk
+    atomic_int stopping;        // The sender has stopped taking chunks
+    atomic_int waiting[2];      // The sender [0], the reader [1] is asleep
+    off_t limit;                // Bytes left to read, -1 for the whole file
+    int holding;                // The sender still has the chunk at head
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+} ReadAhead;
+
+/*
+===============================================================================
+FUNCTION:       Start Read Ahead
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      ReadAhead* StartReadAhead(struct FileSource* src,
+                                          size_t size, off_t limit)
+
+PARAMETERS:     struct FileSource* src
+                    Where the chunks come from, only read by the reader
+                    until Stop Read Ahead.
+                size_t size
+                    Bytes in a chunk.
+                off_t limit
+                    Bytes to read, -1 for the whole file. A file that ends
+                    early is padded with zeroes up to the limit, the same
+                    as Send Contents does.
+
+RETURNS:        -Returns NULL if the reader could not be started.
+                -Returns the running read ahead on success.
+
+NOTES:
+The reader blocks SIGINT and SIGCHLD so that those signals still reach the
+thread sending the transfer.
+===============================================================================
+*/
+ReadAhead* StartReadAhead(struct FileSource* src, size_t size, off_t limit);
+
+/*
+===============================================================================
+FUNCTION:       Take Ahead
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      Mesg* TakeAhead(ReadAhead* ahead, TraceRecord* record)
+
+PARAMETERS:     ReadAhead* ahead
+                    The running read ahead.
+                TraceRecord* record
+                    Given the start and length of the chunk's read, may be
+                    NULL.
+
+RETURNS:        -Returns NULL at the end of the file.
+                -Returns the next chunk, mesg_data and mesg_len filled in.
+
+NOTES:
+The chunk taken before is given back to the reader, a chunk therefore stays
+the sender's until the next one is taken.
+===============================================================================
+*/
+Mesg* TakeAhead(ReadAhead* ahead, TraceRecord* record);
+
+/*
+===============================================================================
+FUNCTION:       Resize Ahead
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void ResizeAhead(ReadAhead* ahead, size_t size)
+
+PARAMETERS:     ReadAhead* ahead
+                    The running read ahead.
+                size_t size
+                    Bytes in the chunks read from now on.
+
+RETURNS:        void
+
+NOTES:
+The chunks already read keep their size.
+===============================================================================
+*/
+void ResizeAhead(ReadAhead* ahead, size_t size);
+
+/*
+===============================================================================
+FUNCTION:       Stop Read Ahead
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void StopReadAhead(ReadAhead* ahead)
+
+PARAMETERS:     ReadAhead* ahead
+                    The read ahead, may be NULL.
+
+RETURNS:        void
+
+NOTES:
+Stops the reader wherever it is, joins it and frees the chunks. The file
+source is the caller's again afterwards.
+===============================================================================
+*/
+void StopReadAhead(ReadAhead* ahead);
+
+#endif
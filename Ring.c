@@ -0,0 +1,226 @@
+/*
+===============================================================================
+SOURCE FILE:    Ring.c
+                    Definition file for the shared memory ring.
+
+PROGRAM:        Client / Server
+
+FUNCTIONS:      int CreateRing(size_t size, Ring** ring)
+                Ring* AttachRing(int shmid)
+                void DetachRing(Ring* ring)
+                size_t RingWriteSpace(Ring* ring, char** where)
+                void RingCommit(Ring* ring, size_t n)
+                void RingClose(Ring* ring)
+                size_t RingReadSpace(Ring* ring, char** where)
+                void RingRelease(Ring* ring, size_t n)
+                static int RingWait(atomic_uint* word, unsigned int value)
+                static void RingWake(atomic_uint* word)
+                static int PeerAlive(atomic_int* peer)
+
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER:     agent
+
+NOTES:
+The waiting flags and the counters use sequentially consistent atomics: a
+side sets its waiting flag and then checks the counter again, the other side
+updates the counter and then checks the flag, so a wake up is never lost.
+===============================================================================
+*/
+
+#include <time.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include "Ring.h"
+
+/* Sleeps while the futex word still holds value. Returns -1 on a signal. */
+static int RingWait(atomic_uint* word, unsigned int value)
+{
+    struct timespec timeout = { RING_TIMEOUT, 0 };
+
+    if(syscall(SYS_futex, (unsigned int*)word, FUTEX_WAIT, value, &timeout,
+        NULL, 0) < 0 && errno == EINTR)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Wakes the peer sleeping on the futex word. */
+static void RingWake(atomic_uint* word)
+{
+    syscall(SYS_futex, (unsigned int*)word, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+/* The peer is alive until it has attached and its process is gone. */
+static int PeerAlive(atomic_int* peer)
+{
+    pid_t pid = atomic_load(peer);
+
+    return pid == 0 || kill(pid, 0) == 0 || errno != ESRCH;
+}
+
+int CreateRing(size_t size, Ring** ring)
+{
+    int shmid;
+    Ring* r;
+
+    shmid = shmget(IPC_PRIVATE, sizeof(Ring) + size, SHMPERM | IPC_CREAT);
+    if(shmid < 0)
+    {
+        return -1;
+    }
+
+    r = shmat(shmid, NULL, 0);
+    shmctl(shmid, IPC_RMID, NULL);
+    if(r == (void*)-1)
+    {
+        return -1;
+    }
+
+    atomic_init(&r->head, 0);
+    atomic_init(&r->tail, 0);
+    atomic_init(&r->closed, 0);
+    atomic_init(&r->prod_waiting, 0);
+    atomic_init(&r->cons_waiting, 0);
+    atomic_init(&r->producer, 0);
+    atomic_init(&r->consumer, getpid());
+    r->created = time(NULL);
+    r->size = size;
+
+    *ring = r;
+    return shmid;
+}
+
+Ring* AttachRing(int shmid)
+{
+    Ring* r;
+
+    r = shmat(shmid, NULL, 0);
+    if(r == (void*)-1)
+    {
+        return NULL;
+    }
+
+    atomic_store(&r->producer, getpid());
+    return r;
+}
+
+void DetachRing(Ring* ring)
+{
+    shmdt(ring);
+}
+
+size_t RingWriteSpace(Ring* ring, char** where)
+{
+    unsigned int head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    unsigned int tail;
+    unsigned int offset;
+    unsigned int free;
+
+    while((tail = atomic_load(&ring->tail)) + ring->size == head)
+    {
+        atomic_store(&ring->prod_waiting, 1);
+        if(atomic_load(&ring->tail) == tail)
+        {
+            if(RingWait(&ring->tail, tail) < 0 || !PeerAlive(&ring->consumer))
+            {
+                atomic_store(&ring->prod_waiting, 0);
+                return 0;
+            }
+        }
+        atomic_store(&ring->prod_waiting, 0);
+    }
+
+    offset = head & (ring->size - 1);
+    free = ring->size - (head - tail);
+    if(free > ring->size - offset)
+    {
+        free = ring->size - offset;
+    }
+
+    *where = ring->data + offset;
+    return free;
+}
+
+void RingCommit(Ring* ring, size_t n)
+{
+    atomic_fetch_add(&ring->head, n);
+
+    if(atomic_load(&ring->cons_waiting))
+    {
+        RingWake(&ring->head);
+    }
+}
+
+void RingClose(Ring* ring)
+{
+    atomic_store(&ring->closed, 1);
+    RingWake(&ring->head);
+}
+
+size_t RingReadSpace(Ring* ring, char** where)
+{
+    unsigned int tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    unsigned int head;
+    unsigned int offset;
+    unsigned int used;
+
+    while((head = atomic_load(&ring->head)) == tail)
+    {
+        if(atomic_load(&ring->closed))
+        {
+            // The producer may have committed just before closing.
+            if(atomic_load(&ring->head) != tail)
+                continue;
+
+            return 0;
+        }
+
+        // A signal only cuts the sleep short, the checks below still run.
+        atomic_store(&ring->cons_waiting, 1);
+        if(atomic_load(&ring->head) == head && !atomic_load(&ring->closed))
+        {
+            RingWait(&ring->head, head);
+        }
+        atomic_store(&ring->cons_waiting, 0);
+
+        // The producer was given the ring but never took it.
+        if(atomic_load(&ring->producer) == 0 &&
+            time(NULL) - ring->created > RING_ATTACH_TIMEOUT)
+        {
+            return 0;
+        }
+
+        // A producer that is gone may still have left data behind.
+        if(atomic_load(&ring->head) == tail && !atomic_load(&ring->closed) &&
+            !PeerAlive(&ring->producer))
+        {
+            return 0;
+        }
+    }
+
+    offset = tail & (ring->size - 1);
+    used = head - tail;
+    if(used > ring->size - offset)
+    {
+        used = ring->size - offset;
+    }
+
+    *where = ring->data + offset;
+    return used;
+}
+
+void RingRelease(Ring* ring, size_t n)
+{
+    atomic_fetch_add(&ring->tail, n);
+
+    if(atomic_load(&ring->prod_waiting))
+    {
+        RingWake(&ring->tail);
+    }
+}
@@ -0,0 +1,273 @@
+/*
+===============================================================================
+SOURCE FILE:    Ring.h
+                    Header file for the shared memory ring used to stream
+                    file contents from the Server to a Client.
+
+PROGRAM:        Client / Server
+
+FUNCTIONS:      int CreateRing(size_t size, Ring** ring)
+                Ring* AttachRing(int shmid)
+                void DetachRing(Ring* ring)
+                size_t RingWriteSpace(Ring* ring, char** where)
+                void RingCommit(Ring* ring, size_t n)
+                void RingClose(Ring* ring)
+                size_t RingReadSpace(Ring* ring, char** where)
+                void RingRelease(Ring* ring, size_t n)
+
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER:     agent
+
+NOTES:
+A single-producer/single-consumer byte ring inside of a SysV shared memory
+segment. The Client creates the segment and sends its id with the request
+("ring=<shmid>"); the message queue then only carries that request while
+the Server reads the file straight into the ring and the Client writes the
+ring straight to its output.
+
+The head and tail are free running counters, only the side that is about to
+sleep sets its waiting flag so a futex wake is only issued when the other
+side is actually asleep. A side that sleeps wakes up every RING_TIMEOUT
+seconds to make sure its peer is still alive. The consumer only waits
+RING_ATTACH_TIMEOUT seconds for a producer that has never attached.
+===============================================================================
+*/
+
+#ifndef RING_H
+#define RING_H
+
+#include <stdatomic.h>
+#include <sys/shm.h>
+#include "Utilities.h"
+
+#define RING_SIZE       (1 << 20)   // Bytes of data inside of a Client's ring
+#define RING_TIMEOUT    1           // Seconds between checks on the peer
+#define RING_ATTACH_TIMEOUT 10      // Seconds the producer has to attach
+
+/*
+Header of the shared memory segment, the data immediately follows it. The
+size is always a power of two.
+*/
+typedef struct
+{
+    atomic_uint head;           // Bytes written by the producer
+    atomic_uint tail;           // Bytes consumed by the consumer
+    atomic_uint closed;         // Set once the producer is finished
+    atomic_uint prod_waiting;   // Producer is asleep on the tail
+    atomic_uint cons_waiting;   // Consumer is asleep on the head
+    atomic_int producer;        // PID of the producer, 0 until attached
+    atomic_int consumer;        // PID of the consumer
+    time_t created;             // When the consumer created the ring
+    unsigned int size;          // Bytes inside of data
+    char data[];
+} Ring;
+
+/*
+===============================================================================
+FUNCTION:       Create Ring
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int CreateRing(size_t size, Ring** ring)
+
+PARAMETERS:     size_t size
+                    Bytes of data inside of the ring, must be a power of two.
+                Ring** ring
+                    Filled in with the attached ring.
+
+RETURNS:        -Returns -1 on failure to create the shared memory segment.
+                -Returns the shared memory id on success.
+
+NOTES:
+Used by the consumer (Client). The segment is marked for removal right away,
+it stays alive for as long as either side is attached so it is never left
+behind when a process dies. It is created SHMPERM since the file passes
+through it, so the Server must run as the same user as the Client.
+===============================================================================
+*/
+int CreateRing(size_t size, Ring** ring);
+
+/*
+===============================================================================
+FUNCTION:       Attach Ring
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      Ring* AttachRing(int shmid)
+
+PARAMETERS:     int shmid
+                    Shared memory id sent by the Client.
+
+RETURNS:        -Returns NULL on failure to attach the ring.
+                -Returns the attached ring on success.
+
+NOTES:
+Used by the producer (Server) to attach to a Client's ring.
+===============================================================================
+*/
+Ring* AttachRing(int shmid);
+
+/*
+===============================================================================
+FUNCTION:       Detach Ring
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void DetachRing(Ring* ring)
+
+PARAMETERS:     Ring* ring
+                    Ring to detach from.
+
+RETURNS:        void
+
+NOTES:
+Wrapper of shmdt.
+===============================================================================
+*/
+void DetachRing(Ring* ring);
+
+/*
+===============================================================================
+FUNCTION:       Ring Write Space
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      size_t RingWriteSpace(Ring* ring, char** where)
+
+PARAMETERS:     Ring* ring
+                    The ring to write into.
+                char** where
+                    Filled in with the start of the free space.
+
+RETURNS:        -Returns 0 if interrupted by a signal or the consumer is gone.
+                -Returns the number of contiguous free bytes at where.
+
+NOTES:
+Sleeps while the ring is full. Nothing is published until Ring Commit.
+===============================================================================
+*/
+size_t RingWriteSpace(Ring* ring, char** where);
+
+/*
+===============================================================================
+FUNCTION:       Ring Commit
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void RingCommit(Ring* ring, size_t n)
+
+PARAMETERS:     Ring* ring
+                    The ring written into.
+                size_t n
+                    Bytes written since Ring Write Space.
+
+RETURNS:        void
+
+NOTES:
+Publishes the written bytes and wakes the consumer if it is asleep.
+===============================================================================
+*/
+void RingCommit(Ring* ring, size_t n);
+
+/*
+===============================================================================
+FUNCTION:       Ring Close
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void RingClose(Ring* ring)
+
+PARAMETERS:     Ring* ring
+                    The ring that the producer is finished with.
+
+RETURNS:        void
+
+NOTES:
+Takes the place of the final message, the consumer reads whatever is left
+and then sees the end of the transfer.
+===============================================================================
+*/
+void RingClose(Ring* ring);
+
+/*
+===============================================================================
+FUNCTION:       Ring Read Space
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      size_t RingReadSpace(Ring* ring, char** where)
+
+PARAMETERS:     Ring* ring
+                    The ring to read from.
+                char** where
+                    Filled in with the start of the readable bytes.
+
+RETURNS:        -Returns 0 once the ring is closed and empty, the
+                producer is gone or it never attached.
+                -Returns the number of contiguous readable bytes at where.
+
+NOTES:
+Sleeps while the ring is empty, a signal does not end the wait. The bytes
+stay in the ring until Ring Release.
+===============================================================================
+*/
+size_t RingReadSpace(Ring* ring, char** where);
+
+/*
+===============================================================================
+FUNCTION:       Ring Release
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void RingRelease(Ring* ring, size_t n)
+
+PARAMETERS:     Ring* ring
+                    The ring read from.
+                size_t n
+                    Bytes consumed since Ring Read Space.
+
+RETURNS:        void
+
+NOTES:
+Frees the consumed bytes and wakes the producer if it is asleep.
+===============================================================================
+*/
+void RingRelease(Ring* ring, size_t n);
+
+#endif
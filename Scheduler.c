@@ -0,0 +1,342 @@
+/*
+===============================================================================
+SOURCE FILE:    Scheduler.c
+                    Definition file for the Server's deficit round robin
+                    scheduler.
+
+PROGRAM:        Server
+
+FUNCTIONS:      int RunScheduler(int queue)
+                int AcceptTransfer(Transfer** active, Mesg* msg, int queue)
+                int ScheduleRound(Transfer** active)
+                int ServeTransfer(Transfer* transfer)
+                int SendChunk(Transfer* transfer)
+                int StopTransfers(Transfer* active)
+                void EndTransfer(Transfer* transfer)
+
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER:     agent
+
+NOTES:
+The final message of a transfer costs no credit so a finished transfer never
+waits a round to leave the list.
+===============================================================================
+*/
+
+#include "Server.h"
+
+int RunScheduler(int queue)
+{
+    Transfer* active = NULL;
+    Transfer* transfer;
+    RequestOptions opts;
+    Mesg* rcv;
+    pid_t child;
+    int result;
+
+    if((rcv = CreateMessage()) == NULL)
+    {
+        return 1;
+    }
+
+    while(!quit)
+    {
+        // Only wait for requests when there is nothing to send.
+        while(!quit)
+        {
+            if(active == NULL)
+                result = ReadRequest(queue, rcv);
+            else
+                result = ReadRequestNoWait(queue, rcv);
+
+            if(result < 0)
+                break;
+
+            ReadRequestOptions(rcv->mesg_data, &opts);
+            if(PlainRequest(&opts))
+            {
+                AcceptTransfer(&active, rcv,
+                    (!posix && opts.queue >= 0) ? opts.queue : queue);
+                continue;
+            }
+
+            fflush(stdout);
+            if((child = fork()) == 0)
+            {
+                ProcessClient(rcv, queue);
+                exit(1);
+            }
+            else if(child > 0)
+            {
+                activeChildren++;
+            }
+        }
+
+        if(active != NULL && ScheduleRound(&active) == 0)
+        {
+            // Every queue was full, give the clients time to read.
+            usleep(DRR_IDLE_WAIT);
+        }
+
+        ReapChildren(0);
+    }
+
+    // Let every client know its transfer has stopped.
+    StopTransfers(active);
+    while((transfer = active) != NULL)
+    {
+        active = transfer->next;
+        EndTransfer(transfer);
+    }
+
+    free(rcv);
+    return 0;
+}
+
+int AcceptTransfer(Transfer** active, Mesg* msg, int queue)
+{
+    Transfer* transfer;
+    char name[BUFF];
+    pid_t client;
+    int priority;
+
+    if(DesignatePriority(msg->mesg_data, name, &priority, &client) < 0)
+    {
+        printf("Fatal error, cannot read message.");
+        return -1;
+    }
+
+    if((transfer = calloc(1, sizeof(Transfer))) == NULL)
+    {
+        return -1;
+    }
+
+    if((transfer->chunk = CreateMessage()) == NULL)
+    {
+        free(transfer);
+        return -1;
+    }
+
+    if(priority < 1)
+        priority = 1;
+    else if(priority > 1000)
+        priority = 1000;
+
+    transfer->client = client;
+    transfer->priority = priority;
+    transfer->quantum = DRR_QUANTUM(priority);
+    transfer->queue = queue;
+    transfer->chunk->mesg_type = client;
+    transfer->chunk->mesg_id = msg->mesg_id;
+
+    if(posix && (transfer->queue =
+        OpenClientPosixQueue(client, O_WRONLY | O_NONBLOCK, 0)) == (mqd_t)-1)
+    {
+        printf("Cannot open the queue of client:%d\n", client);
+        free(transfer->chunk);
+        free(transfer);
+        return -1;
+    }
+
+    StatsRequest(stats);
+    StatsTransfer(stats, 1);
+    if((transfer->file = OpenCachedFile(name, &transfer->entry)) == NULL)
+    {
+        transfer->chunk->mesg_len = sprintf(transfer->chunk->mesg_data,
+            "Cannot open file: %s\n", name);
+        transfer->loaded = 1;
+    }
+    else
+    {
+        printf("Sending %s to client:%d\n", name, client);
+        if(traceDir != NULL)
+            transfer->trace = OpenTrace(traceDir, TRACE_SERVER, client,
+                msg->mesg_id);
+    }
+
+    // New transfers join the end of the round.
+    while(*active != NULL)
+    {
+        active = &(*active)->next;
+    }
+    *active = transfer;
+
+    return 0;
+}
+
+int ScheduleRound(Transfer** active)
+{
+    Transfer* transfer;
+    int sent = 0;
+
+    while((transfer = *active) != NULL)
+    {
+        sent += ServeTransfer(transfer);
+
+        if(transfer->finished && !transfer->loaded)
+        {
+            printf("Sending to %d complete...\n", transfer->client);
+            *active = transfer->next;
+            EndTransfer(transfer);
+            continue;
+        }
+
+        active = &transfer->next;
+    }
+
+    return sent;
+}
+
+int ServeTransfer(Transfer* transfer)
+{
+    Mesg* chunk = transfer->chunk;
+    int sent = 0;
+
+    transfer->deficit += transfer->quantum;
+    transfer->blocked = 0;
+
+    while(1)
+    {
+        if(!transfer->loaded)
+        {
+            if(transfer->trace != NULL)
+                transfer->record.start = MonotonicNs();
+
+            chunk->mesg_len = 0;
+            if(transfer->file != NULL)
+            {
+                // A traced chunk leaves room for its stamp.
+                chunk->mesg_len = fread(chunk->mesg_data, sizeof(char),
+                    messageData - ((transfer->trace != NULL) ? MESGSTAMP : 0),
+                    transfer->file);
+            }
+
+            transfer->finished = (chunk->mesg_len == 0);
+            transfer->loaded = 1;
+
+            if(transfer->trace != NULL && !transfer->finished)
+            {
+                transfer->record.stage =
+                    MonotonicNs() - transfer->record.start;
+                chunk->mesg_seq++;
+            }
+        }
+
+        if(!transfer->finished &&
+            transfer->deficit < (long)chunk->mesg_len)
+            break;
+
+        if(SendChunk(transfer) < 0)
+        {
+            // Still loaded unless the client has gone.
+            transfer->blocked = transfer->loaded;
+            break;
+        }
+
+        sent++;
+        transfer->deficit -= chunk->mesg_len;
+        transfer->loaded = 0;
+
+        if(transfer->finished)
+            break;
+    }
+
+    // A transfer held back by a full queue does not hoard credit.
+    if(transfer->deficit > transfer->quantum)
+    {
+        transfer->deficit = transfer->quantum;
+    }
+
+    return sent;
+}
+
+int SendChunk(Transfer* transfer)
+{
+    TraceRecord* record = &transfer->record;
+    Mesg* chunk = transfer->chunk;
+
+    if(SendReplyNoWait(transfer->queue, chunk, transfer->priority) == 0)
+    {
+        if(transfer->trace != NULL && chunk->mesg_len > 0)
+        {
+            record->seq = chunk->mesg_seq;
+            record->len = chunk->mesg_len;
+            record->sent = chunk->mesg_sent;
+            record->blocked = MonotonicNs() - chunk->mesg_sent;
+            TraceChunk(transfer->trace, record);
+        }
+
+        return 0;
+    }
+
+    if(errno != EAGAIN)
+    {
+        // The client is gone, drop the rest of the transfer.
+        transfer->finished = 1;
+        transfer->loaded = 0;
+    }
+
+    return -1;
+}
+
+int StopTransfers(Transfer* active)
+{
+    long long deadline = MonotonicNs() + DRR_STOP_WAIT * 1000LL;
+    Transfer* transfer;
+    int waiting = 0;
+
+    for(transfer = active; transfer != NULL; transfer = transfer->next)
+    {
+        transfer->chunk->mesg_len = 0;
+        transfer->loaded = 1;
+        waiting++;
+    }
+
+    while(1)
+    {
+        // A send either ends the transfer or fails for good, unless full.
+        for(transfer = active; transfer != NULL; transfer = transfer->next)
+        {
+            if(transfer->loaded &&
+                (SendChunk(transfer) == 0 || errno != EAGAIN))
+            {
+                transfer->loaded = 0;
+                waiting--;
+            }
+        }
+
+        if(waiting == 0 || MonotonicNs() >= deadline)
+            break;
+
+        usleep(DRR_IDLE_WAIT);
+    }
+
+    return waiting;
+}
+
+void EndTransfer(Transfer* transfer)
+{
+    if(transfer->file != NULL)
+    {
+        fclose(transfer->file);
+    }
+
+    if(transfer->entry != NULL)
+    {
+        CacheClose(cache, transfer->entry);
+    }
+
+    if(posix)
+    {
+        mq_close(transfer->queue);
+    }
+
+    StatsTransfer(stats, -1);
+    CloseTrace(transfer->trace);
+    free(transfer->chunk);
+    free(transfer);
+}
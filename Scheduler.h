@@ -0,0 +1,257 @@
+/*
+===============================================================================
+SOURCE FILE:    Scheduler.h
+                    Header file for the Server's deficit round robin
+                    scheduler.
+
+PROGRAM:        Server
+
+FUNCTIONS:      int RunScheduler(int queue)
+                int AcceptTransfer(Transfer** active, Mesg* msg, int queue)
+                int ScheduleRound(Transfer** active)
+                int ServeTransfer(Transfer* transfer)
+                int SendChunk(Transfer* transfer)
+                int StopTransfers(Transfer* active)
+                void EndTransfer(Transfer* transfer)
+
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER:     agent
+
+NOTES:
+Without the scheduler the priority only shrinks the chunks of a transfer
+(messageData / priority) while every forked child competes equally for
+the message queue. With the scheduler (Server -s) one process drives every
+transfer, always sends full messageData chunks and decides whose chunk
+goes next with deficit round robin: every round each transfer earns a
+quantum of bytes proportional to its weight (1000 / priority) and sends
+chunks while it has enough credit. A priority 1 transfer therefore gets 1000
+times the bandwidth of a priority 1000 transfer without either one sending
+more messages than its file needs.
+
+The sends never block. A transfer whose chunk does not fit on the queue
+keeps the chunk and tries again on a later round. When traced, the rounds a
+chunk waits between its read and its send show as its wait, and the chunks
+are MESGSTAMP bytes short of full to leave room for the stamp.
+===============================================================================
+*/
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "Utilities.h"
+#include "Cache.h"
+#include "Trace.h"
+
+/* Bytes a transfer earns per round: a full chunk times its weight. */
+#define DRR_QUANTUM(priority)   ((long)messageData * 1000 / (priority))
+#define DRR_IDLE_WAIT           1000    // Microseconds to wait on a full queue
+#define DRR_STOP_WAIT           1000000 // Microseconds to end the transfers
+
+/* One file being sent to one Client. */
+typedef struct Transfer
+{
+    FILE* file;
+    CacheEntry* entry;          // Cache entry the file is read from, if any
+    int queue;                  // Reply queue of the Client
+    pid_t client;
+    int priority;
+    long quantum;               // Bytes earned per round
+    long deficit;               // Bytes the transfer may still send
+    int loaded;                 // chunk holds a message not yet sent
+    int finished;               // chunk is the final message
+    int blocked;                // The last send found the queue full
+    int registered;             // Queue is registered with the event loop
+    struct Transfer* prev;      // Previous transfer, event loop only
+    Mesg* chunk;
+    Trace* trace;               // Latency trace, NULL when not traced
+    TraceRecord record;         // Trace of the chunk loaded
+    struct Transfer* next;
+} Transfer;
+
+/*
+===============================================================================
+FUNCTION:       Run Scheduler
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int RunScheduler(int queue)
+
+PARAMETERS:     int queue
+                    The SysV message queue or the POSIX request queue.
+
+RETURNS:        Returns 0 once the Server quits.
+
+NOTES:
+Takes the place of Search For Clients. Waits for requests while there is
+nothing to send, otherwise checks for new requests between rounds. Requests
+for the shared memory ring or the open file never touch the queue so they
+are still handed to a forked child, as are batches of many files,
+compressed transfers, transfers under flow control and stats requests.
+===============================================================================
+*/
+int RunScheduler(int queue);
+
+/*
+===============================================================================
+FUNCTION:       Accept Transfer
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int AcceptTransfer(Transfer** active, Mesg* msg, int queue)
+
+PARAMETERS:     Transfer** active
+                    List of the transfers in progress.
+                Mesg* msg
+                    The Client's request.
+                int queue
+                    The SysV queue to reply on, the request queue on the
+                    POSIX backend.
+
+RETURNS:        -Returns -1 if the request could not be read.
+                -Returns 0 on success.
+
+NOTES:
+Adds a transfer for the request. A file that cannot be opened becomes a
+transfer of the error text followed by the final message.
+===============================================================================
+*/
+int AcceptTransfer(Transfer** active, Mesg* msg, int queue);
+
+/*
+===============================================================================
+FUNCTION:       Schedule Round
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int ScheduleRound(Transfer** active)
+
+PARAMETERS:     Transfer** active
+                    List of the transfers in progress.
+
+RETURNS:        Returns the number of messages sent during the round.
+
+NOTES:
+One deficit round robin round over every transfer. Finished transfers are
+removed from the list.
+===============================================================================
+*/
+int ScheduleRound(Transfer** active);
+
+/*
+===============================================================================
+FUNCTION:       Serve Transfer
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int ServeTransfer(Transfer* transfer)
+
+PARAMETERS:     Transfer* transfer
+                    The transfer whose turn it is.
+
+RETURNS:        Returns the number of messages sent.
+
+NOTES:
+One turn of a transfer: it earns its quantum and sends chunks while it has
+enough credit. Sets blocked when the turn ended on a full queue. The transfer
+is done once finished is set and no chunk is loaded.
+===============================================================================
+*/
+int ServeTransfer(Transfer* transfer);
+
+/*
+===============================================================================
+FUNCTION:       Send Chunk
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int SendChunk(Transfer* transfer)
+
+PARAMETERS:     Transfer* transfer
+                    The transfer whose chunk is sent.
+
+RETURNS:        -Returns -1 if the queue is full.
+                -Returns 0 once the chunk has been sent.
+
+NOTES:
+Sends the loaded chunk without blocking. Any other failure to send ends the
+transfer since the Client can no longer be reached.
+===============================================================================
+*/
+int SendChunk(Transfer* transfer);
+
+/*
+===============================================================================
+FUNCTION:       Stop Transfers
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int StopTransfers(Transfer* active)
+
+PARAMETERS:     Transfer* active
+                    The transfers still going when the Server stops.
+
+RETURNS:        Returns the number of Clients which could not be told.
+
+NOTES:
+Sends every Client the empty message ending its transfer, which is how it
+learns the file was cut short. A full queue is tried again every
+DRR_IDLE_WAIT for up to DRR_STOP_WAIT in all, so a Client still reading gets
+its end while one which has stopped cannot keep the Server from exiting.
+The transfers are left for End Transfer.
+===============================================================================
+*/
+int StopTransfers(Transfer* active);
+
+/*
+===============================================================================
+FUNCTION:       End Transfer
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void EndTransfer(Transfer* transfer)
+
+PARAMETERS:     Transfer* transfer
+                    The transfer to release.
+
+RETURNS:        void
+
+NOTES:
+Closes the file, gives back its cache entry, closes the Client's POSIX queue
+and frees the transfer and its chunk.
+===============================================================================
+*/
+void EndTransfer(Transfer* transfer);
+
+#endif
@@ -5,18 +5,81 @@ SOURCE FILE:    Server.c
 
 PROGRAM:        Server
 
-FUNCTIONS:      int main(void)
+FUNCTIONS:      int main(int argc, char** argv)
                 int Server(void)
+                int ReadServerArguments(int argc, char** argv)
+                void ServerHelp(void)
+                int ReadRequest(int queue, Mesg* msg)
+                int SendReply(int queue, Mesg* msg, int priority)
+                int ReadRequestNoWait(int queue, Mesg* msg)
+                int SendReplyNoWait(int queue, Mesg* msg, int priority)
+                int ReplyBacklog(int queue)
                 int SearchForClients(void)
+                int DispatchCoalesced(Mesg* first)
+                int ReadCoalesceKey(Mesg* msg, CoalesceKey* key)
+                int JoinCoalescedRead(const CoalesceKey* key,
+                      Mesg** group, int count)
+                int EndCoalescedRead(pid_t child)
+                int ServeCoalesced(Mesg** requests, int count,
+                      const int* join)
+                int AddMember(CoalesceGroup* group, Mesg* request)
+                static int SameCoalesceKey(const CoalesceKey* a,
+                      const CoalesceKey* b)
+                static void* RunMember(void* arg)
+                static void* RunJoins(void* arg)
+                static size_t ReadGroupFile(CoalesceGroup* group,
+                      char* where, size_t size, off_t at)
+                void ReapChildren(int block)
+                int RunWorkerPool(void)
+                pid_t SpawnWorker(void)
+                int RunThreadPool(void)
                 int ProcessClient(Mesg* msg, int queue)
+                FILE* OpenCachedFile(const char* name, CacheEntry** entry)
                 int DesignatePriority(const char* text,
                       char* name,
                       int* priority,
                       pid_t* client)
+                int ReadRequestOptions(const char* text,
+                      RequestOptions* opts)
+                int PlainRequest(const RequestOptions* opts)
                 int PacketizeData(FILE* fp,
                       const int queue,
                       const long msg_type,
-                      const int priority)
+                      const long request,
+                      const int priority,
+                      Credit* credit,
+                      Trace* trace)
+                int SendContents(FILE* fp, Mesg* snd, int queue,
+                      int priority, off_t limit, Credit* credit,
+                      Trace* trace)
+                size_t ChunkSize(int priority)
+                int PacketizeCompressed(FILE* fp,
+                      const int queue,
+                      const long msg_type,
+                      const long request,
+                      const int priority,
+                      Credit* credit)
+                int AnswerCompression(int queue, long msg_type,
+                      long request, int priority, int accepted)
+                int OpenCredit(Credit* credit, int queue, pid_t client,
+                      long window)
+                int TakeCredit(Credit* credit)
+                int SendWithCredit(int queue, Mesg* msg, int priority,
+                      Credit* credit)
+                void CloseCredit(Credit* credit)
+                int ProcessBatch(const char* pattern, int queue,
+                      pid_t client, long request, int priority,
+                      Credit* credit, Trace* trace)
+                void OpenSource(FileSource* src, FILE* fp)
+                size_t ReadChunk(FileSource* src, char* where, size_t size)
+                void CloseSource(FileSource* src)
+                int StreamToRing(const char* name, pid_t client, int shmid)
+                int DeliverDescriptor(const char* name, pid_t client)
+                int SendStats(int queue, long msg_type, long request,
+                      int priority)
+                pid_t SpawnStatsDumper(const char* path)
+                void child_handler(int sig)
+                void bus_handler(int sig)
                 void sig_handler(int sig)
 
 
@@ -35,6 +98,85 @@ REVISIONS:      January 31, 2016        (Tyler Trepanier-Bracken)
                     Client has their own definitions of the sig_handler
                     with their own implementations.
 
+                October 17, 2026        (agent)
+                    Added the POSIX message queue backend (-P) alongside the
+                    SysV message queue.
+
+                October 17, 2026        (agent)
+                    Clients may send a shared memory ring with their request,
+                    the file is then streamed through the ring instead of the
+                    message queue.
+
+                October 17, 2026        (agent)
+                    Clients may ask for the open file itself, which is passed
+                    over a Unix socket instead of being sent in chunks.
+
+                October 17, 2026        (agent)
+                    Added the pre-forked worker pool (-w) and the limit on
+                    children forked per request (-c). Finished children are
+                    now reaped.
+
+                October 17, 2026        (agent)
+                    Added the multithreaded engine (-t) which serves the
+                    requests from a work-stealing thread pool.
+
+                October 17, 2026        (agent)
+                    Added the deficit round robin scheduler (-s) which turns
+                    the priority into a share of the queue.
+
+                October 17, 2026        (agent)
+                    The chunks are sized by the limits of the queue instead
+                    of MAXMESSAGEDATA and may grow while the reply queue is
+                    drained (-a).
+
+                October 17, 2026        (agent)
+                    Clients may send their own SysV reply queue with their
+                    request.
+
+                October 17, 2026        (agent)
+                    Added the shared content cache (-m) for hot files.
+
+                October 17, 2026        (agent)
+                    Files may be sent from a memory mapping (-M).
+
+                October 17, 2026        (agent)
+                    A request may ask for a batch of files, served by one
+                    worker with each file framed in the reply stream.
+
+                October 17, 2026        (agent)
+                    Every reply carries the mesg_id of its request.
+
+                October 17, 2026        (agent)
+                    Chunks may be sent compressed (zip=1) when the Server
+                    is built with USE_ZLIB.
+
+                October 17, 2026        (agent)
+                    Added credit based flow control (credit=N), no Client
+                    has more than its window of chunks on the queue.
+
+                October 17, 2026        (agent)
+                    Added live statistics, answered to stats=1 requests and
+                    dumped as JSON lines with -j.
+
+                October 17, 2026        (agent)
+                    Added per chunk latency traces (-T).
+
+                October 17, 2026        (agent)
+                    Requests for the same file may share one read of it
+                    (-g), those made while it is read join it.
+
+                October 17, 2026        (agent)
+                    Added the single threaded event loop (-e) over the POSIX
+                    queues.
+
+                October 17, 2026        (agent)
+                    Files may be read ahead of the sends through io_uring
+                    (-u) when the Server is built with USE_URING.
+
+                October 17, 2026        (agent)
+                    Files may be read by a thread of their own while the
+                    chunks read before are sent (-R).
+
 DESIGNGER:      Tyler Trepanier-Bracken
 
 PROGRAMMER:     Tyler Trepanier-Bracken
@@ -59,14 +201,46 @@ inside of the Utilities files.
 */
 #include "Server.h"
 
+static int SameCoalesceKey(const CoalesceKey* a, const CoalesceKey* b);
+static void* RunMember(void* arg);
+static void* RunJoins(void* arg);
+static size_t ReadGroupFile(CoalesceGroup* group, char* where, size_t size,
+                            off_t at);
+
 Mesg* kill_client_msg;
 
 extern int errno;       // error NO.
 int quit = 0;
 
-int main(void)
+int posix = 0;          // Use the POSIX message queues instead of SysV.
+long maxmsg = 0;        // Capacity of the POSIX request queue.
+
+int workers = 0;        // Size of the pre-forked worker pool, 0 for none.
+int maxChildren = 0;    // Limit on the children forked per request.
+int activeChildren = 0; // Children forked per request which are running.
+int threads = 0;        // Size of the work-stealing thread pool, 0 for none.
+int scheduled = 0;      // Share the queue with the deficit round robin.
+int evented = 0;        // Serve every transfer from one epoll loop.
+int adaptive = 0;       // Grow the chunks while the reply queue is drained.
+size_t cacheBudget = 0; // Bytes of file contents kept in memory, 0 for none.
+int mapped = 0;         // Send the files from a memory mapping.
+int uring = 0;          // Read the files ahead through io_uring.
+int readAhead = 0;      // Read the files from a thread of their own.
+int coalesce = 0;       // Share one read between identical requests.
+CoalesceRead reads[COALESCE_READS];     // Reads in progress with -g.
+Cache* cache = NULL;    // Contents of the files most recently sent.
+Stats* stats = NULL;    // Counters shared by every worker.
+const char* statsPath = NULL;   // Where the statistics are dumped, -j.
+const char* traceDir = NULL;    // Where the transfers are traced, -T.
+__thread sigjmp_buf* mapFault = NULL;   // Set while copying from a mapping.
+
+int main(int argc, char** argv)
 {
-    
+    int result;
+
+    if(ReadServerArguments(argc, argv) < 0)
+        return 1;
+
     sa.sa_handler = sig_handler;
     sigemptyset (&sa.sa_mask);
     sa.sa_flags = 0;
@@ -74,38 +248,305 @@ int main(void)
     sigaction (SIGINT, &sa, &oldint);
     sigaction (SIGTSTP, &sa, NULL);
 
-    Server();
+    // Finished children interrupt the wait for requests so they are reaped.
+    sa.sa_handler = child_handler;
+    sigaction (SIGCHLD, &sa, NULL);
+
+    // A mapped file truncated under a transfer only fails that transfer.
+    sa.sa_handler = bus_handler;
+    sigaction (SIGBUS, &sa, NULL);
+
+    result = Server();
 
     // Restore normal action
     sigaction (SIGINT, &oldint, NULL);
 
-    return 0;
+    return result;
 }
 
 int Server(void)
 {
+    pid_t dumper = -1;
+    mqd_t queue;
+
+    // Created before any fork so that every worker shares it.
+    if(cacheBudget > 0 && (cache = CreateCache(cacheBudget)) == NULL)
+    {
+        printf("Cannot create the cache, files are read from the disk.\n");
+    }
+
+    if((stats = CreateStats()) == NULL)
+    {
+        printf("Cannot create the statistics, none are kept.\n");
+    }
+
+    if(posix)
+    {
+        messageData = PosixMessageLimit();
+        queue = OpenPosixQueue(SERVER_MQ_NAME, O_RDONLY | O_CREAT, maxmsg);
+        if(queue == (mqd_t)-1)
+        {
+            perror("Cannot create the request queue");
+            return 1;
+        }
+
+        msgQueue = queue;
+        if(statsPath != NULL)
+            dumper = SpawnStatsDumper(statsPath);
+
+        SearchForClients();
+
+        if(dumper > 0)
+        {
+            kill(dumper, SIGINT);
+            waitpid(dumper, NULL, 0);
+        }
+
+        mq_close(queue);
+        mq_unlink(SERVER_MQ_NAME);
+        return 0;
+    }
 
     if(OpenQueue() < 0)
         return 1;
 
+    if(statsPath != NULL)
+        dumper = SpawnStatsDumper(statsPath);
+
     SearchForClients();
 
+    if(dumper > 0)
+    {
+        kill(dumper, SIGINT);
+        waitpid(dumper, NULL, 0);
+    }
+
     RemoveQueue(msgQueue);
     return 0;
 }
 
+int ReadServerArguments(int argc, char** argv)
+{
+    int opt;
+
+    while((opt = getopt(argc, argv, "Pn:w:c:t:sam:MuRj:T:ge")) != -1)
+    {
+        switch(opt)
+        {
+        case 'P':
+            posix = 1;
+            break;
+        case 'n':
+            maxmsg = atol(optarg);
+            break;
+        case 'w':
+            workers = atoi(optarg);
+            if(workers < 0 || workers > MAXWORKERS)
+            {
+                ServerHelp();
+                return -1;
+            }
+            break;
+        case 'c':
+            maxChildren = atoi(optarg);
+            break;
+        case 's':
+            scheduled = 1;
+            break;
+        case 'a':
+            adaptive = 1;
+            break;
+        case 'm':
+            cacheBudget = (size_t)atol(optarg) << 20;
+            break;
+        case 'M':
+            mapped = 1;
+            break;
+        case 'u':
+#ifndef USE_URING
+            printf("Built without io_uring, -u reads with pread.\n");
+#endif
+            uring = 1;
+            break;
+        case 'R':
+            readAhead = 1;
+            break;
+        case 'j':
+            statsPath = optarg;
+            break;
+        case 'T':
+            traceDir = optarg;
+            break;
+        case 'g':
+            coalesce = 1;
+            break;
+        case 'e':
+            evented = 1;
+            break;
+        case 't':
+            threads = atoi(optarg);
+            if(threads < 0 || threads > MAXTHREADS)
+            {
+                ServerHelp();
+                return -1;
+            }
+            break;
+        default:
+            ServerHelp();
+            return -1;
+        }
+    }
+
+    // Only the POSIX queues are descriptors epoll can watch.
+    if(evented && !posix)
+    {
+        printf("The event loop (-e) needs the POSIX queues (-P).\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+void ServerHelp(void)
+{
+    printf("Usage: ./Server [-P] [-n maxmsg] [-w workers | -c limit | "
+        "-t threads | -s | -e] [-a] [-m megabytes] [-M | -u] "
+        "[-R] [-j file] [-T dir] [-g]\n");
+    printf("  -P         use POSIX message queues instead of SysV.\n");
+    printf("  -n maxmsg  capacity of the POSIX request queue.\n");
+    printf("  -w workers serve from a pool of pre-forked workers (max %d).\n",
+        MAXWORKERS);
+    printf("  -c limit   most children forked per request at once.\n");
+    printf("  -t threads serve from a work-stealing thread pool (max %d).\n",
+        MAXTHREADS);
+    printf("  -s         schedule full chunks by priority weight (DRR).\n");
+    printf("  -e         serve every transfer from one epoll loop, needs -P.\n");
+    printf("  -a         grow the chunks while the client keeps up.\n");
+    printf("  -m mbytes  keep the files most recently sent in memory.\n");
+    printf("  -M         send the files from a memory mapping.\n");
+    printf("  -u         read the files ahead through io_uring.\n");
+    printf("  -R         read the files from a thread while sending.\n");
+    printf("  -j file    append the statistics as JSON every %d s, - for "
+        "stdout.\n", STATS_INTERVAL);
+    printf("  -T dir     trace every chunk of the transfers into dir.\n");
+    printf("  -g         read a file once for the requests made while it is read.\n");
+}
+
+int ReadRequest(int queue, Mesg* msg)
+{
+    if(posix)
+        return ReadPosixMessage(queue, msg);
+
+    return ReadMessage(queue, msg, CLIENT_TO_SERVER);
+}
+
+int SendReply(int queue, Mesg* msg, int priority)
+{
+    struct timespec start;
+    unsigned long blocked = 0;
+    int result;
+
+    if(posix)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        result = SendPosixMessage(queue, msg, PosixPriority(priority));
+        blocked = ElapsedNs(&start);
+    }
+    else if((result = SendMessageNoWait(queue, msg)) < 0 && errno == EAGAIN)
+    {
+        // The queue is full, from here on the sender is blocked.
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        result = SendMessage(queue, msg);
+        blocked = ElapsedNs(&start);
+    }
+
+    if(result == 0)
+        StatsSent(stats, msg->mesg_len, blocked);
+
+    return result;
+}
+
+int ReadRequestNoWait(int queue, Mesg* msg)
+{
+    if(posix)
+        return ReadPosixMessageNoWait(queue, msg);
+
+    return ReadMessageNoWait(queue, msg, CLIENT_TO_SERVER);
+}
+
+int SendReplyNoWait(int queue, Mesg* msg, int priority)
+{
+    int result;
+
+    // POSIX reply queues are opened with O_NONBLOCK for this.
+    if(posix)
+        result = SendPosixMessage(queue, msg, PosixPriority(priority));
+    else
+        result = SendMessageNoWait(queue, msg);
+
+    if(result == 0)
+        StatsSent(stats, msg->mesg_len, 0);
+
+    return result;
+}
+
+int ReplyBacklog(int queue)
+{
+    if(posix)
+        return PosixQueueLength(queue);
+
+    return QueueLength(queue);
+}
+
 int SearchForClients(void)
 {
-    Mesg rcv;
+    Mesg* rcv;
+
+    if(workers > 0)
+    {
+        return RunWorkerPool();
+    }
+
+    if(threads > 0)
+    {
+        return RunThreadPool();
+    }
+
+    if(scheduled)
+    {
+        return RunScheduler(msgQueue);
+    }
+
+    if(evented)
+    {
+        return RunEventLoop(msgQueue);
+    }
+
+    if((rcv = CreateMessage()) == NULL)
+    {
+        return 1;
+    }
 
-    rcv.mesg_type = CLIENT_TO_SERVER;
-    sprintf(rcv.mesg_data, "   ");
-    kill_client_msg = &rcv;
+    rcv->mesg_type = CLIENT_TO_SERVER;
+    sprintf(rcv->mesg_data, "   ");
+    kill_client_msg = rcv;
 
     while (!quit){
-        if(ReadMessage(msgQueue, &rcv, CLIENT_TO_SERVER) == 0)
+        // Wait for a child to finish while at the limit.
+        ReapChildren(maxChildren > 0 && activeChildren >= maxChildren);
+        if(maxChildren > 0 && activeChildren >= maxChildren)
+            continue;
+
+        if(ReadRequest(msgQueue, rcv) == 0)
         {
             pid_t child;
+
+            if(coalesce)
+            {
+                DispatchCoalesced(rcv);
+                continue;
+            }
+
             child = fork();
             
             switch(child)
@@ -114,12 +555,13 @@ int SearchForClients(void)
                 printf("Fatal error.\n");
                 break;
             case 0: //child
-                kill_client_msg = &rcv;
-                ProcessClient(&rcv, msgQueue);
+                kill_client_msg = rcv;
+                ProcessClient(rcv, msgQueue);
                 exit(1);
                 break;
 
             default: //parent
+                activeChildren++;
                 break;
             }
 
@@ -127,105 +569,1729 @@ int SearchForClients(void)
 
     }
 
+    free(rcv);
     return 0;
 }
 
-int ProcessClient(Mesg* msg, int queue)
+int DispatchCoalesced(Mesg* first)
 {
-    FILE* file;
-    char name[BUFF];
-    pid_t client;
-    int priority;
+    Mesg* pending[COALESCE_MAX];
+    CoalesceKey keys[COALESCE_MAX];
+    Mesg* group[COALESCE_MAX];
+    CoalesceRead* read;
+    int usable[COALESCE_MAX];
+    int count;
+    int members;
+    int joined;
+    int i;
+    int j;
+    pid_t child;
 
-    if(DesignatePriority(msg->mesg_data, name, &priority, &client) < 0)
+    if((pending[0] = CreateMessage()) == NULL)
     {
-        printf("Fatal error, cannot read message.");
         return -1;
     }
+    memcpy(pending[0], first, offsetof(Mesg, mesg_data) + first->mesg_len + 1);
 
-    if((file = OpenFile(name)) == NULL)
+    // Whatever queued up behind the first request arrived along with it.
+    for(count = 1; count < COALESCE_MAX; count++)
     {
-        msg->mesg_type = client;
-        sprintf(msg->mesg_data, "Cannot open file: %s\n", name);
-       if(SendMessage(queue, msg) < 0){
-            return -1;
-        }
+        if((pending[count] = CreateMessage()) == NULL)
+            break;
 
-        if(SendFinalMessage(queue, msg) < 0)
+        if(ReadRequestNoWait(msgQueue, pending[count]) < 0)
         {
-            return -1;
+            free(pending[count]);
+            break;
         }
+    }
 
-        return 0;
+    for(i = 0; i < count; i++)
+    {
+        usable[i] = (ReadCoalesceKey(pending[i], &keys[i]) == 0);
     }
-    else
+
+    for(i = 0; i < count; i++)
     {
-        printf("Sending %s to client:%d\n", name, client);
-        PacketizeData(file, queue, (long)client, priority);
+        if(pending[i] == NULL)
+            continue;
+
+        group[0] = pending[i];
+        members = 1;
+        for(j = i + 1; j < count && usable[i]; j++)
+        {
+            if(pending[j] != NULL && usable[j] &&
+                SameCoalesceKey(&keys[i], &keys[j]))
+            {
+                group[members++] = pending[j];
+                pending[j] = NULL;
+            }
+        }
+        pending[i] = NULL;
+
+        // Late requests join a read of the file already going.
+        joined = usable[i] ? JoinCoalescedRead(&keys[i], group, members) : 0;
+
+        if(joined < members)
+        {
+            // Every new read is one child, and counts once against the limit.
+            while(!quit && maxChildren > 0 && activeChildren >= maxChildren)
+            {
+                ReapChildren(1);
+            }
+
+            // The read is kept in the table while it goes, for those to come.
+            for(j = 0, read = NULL; j < COALESCE_READS && usable[i]; j++)
+            {
+                if(reads[j].child == 0)
+                {
+                    read = &reads[j];
+                    break;
+                }
+            }
+
+            if(read != NULL && socketpair(AF_UNIX, SOCK_SEQPACKET, 0,
+                read->join) < 0)
+            {
+                read = NULL;
+            }
+
+            fflush(stdout);
+            if((child = fork()) == 0)
+            {
+                // Only its own read is the child's to take requests for.
+                for(j = 0; j < COALESCE_READS; j++)
+                {
+                    if(reads[j].child != 0)
+                    {
+                        close(reads[j].join[0]);
+                        close(reads[j].join[1]);
+                    }
+                }
+
+                if(read == NULL && members == 1)
+                    ProcessClient(group[0], msgQueue);
+                else
+                    ServeCoalesced(group + joined, members - joined,
+                        (read != NULL) ? read->join : NULL);
+                exit(1);
+            }
+            else if(child > 0)
+            {
+                activeChildren++;
+                if(read != NULL)
+                {
+                    read->key = keys[i];
+                    read->child = child;
+                }
+            }
+            else
+            {
+                printf("Fatal error.\n");
+                if(read != NULL)
+                {
+                    close(read->join[0]);
+                    close(read->join[1]);
+                }
+            }
+        }
+
+        for(j = 0; j < members; j++)
+        {
+            free(group[j]);
+        }
     }
 
     return 0;
 }
 
+/* Whether two requests are for the same version of a file at one priority. */
+static int SameCoalesceKey(const CoalesceKey* a, const CoalesceKey* b)
+{
+    return a->dev == b->dev && a->ino == b->ino && a->size == b->size &&
+        a->mtime.tv_sec == b->mtime.tv_sec &&
+        a->mtime.tv_nsec == b->mtime.tv_nsec &&
+        a->priority == b->priority;
+}
 
-
-int DesignatePriority(const char* text,
-                      char* name,
-                      int* priority,
-                      pid_t* client)
+int JoinCoalescedRead(const CoalesceKey* key, Mesg** group, int count)
 {
+    int joined = 0;
+    int i;
 
-    int n = sscanf(text, "%s %d %d", name, priority, client);
-    
-    if (n == 3)
+    for(i = 0; i < COALESCE_READS; i++)
     {
-        return 1;
+        if(reads[i].child != 0 && SameCoalesceKey(&reads[i].key, key))
+            break;
     }
 
-    return -1;
+    if(i == COALESCE_READS)
+    {
+        return 0;
+    }
+
+    // The child takes them in the order sent, a full socket ends the joining.
+    for(; joined < count; joined++)
+    {
+        if(send(reads[i].join[1], &group[joined]->mesg_id,
+            MESGSIZE(group[joined]->mesg_len), MSG_DONTWAIT) < 0)
+        {
+            break;
+        }
+    }
+
+    return joined;
 }
 
-int PacketizeData(FILE* fp,
-                  const int queue,
-                  const long msg_type,
-                  const int priority)
+int EndCoalescedRead(pid_t child)
 {
-    Mesg snd;
-    int m_size = MAXMESSAGEDATA-1;
-    size_t i;
-
-    if (priority < 0)
-        m_size = MAXMESSAGEDATA-1;
-    else if (priority > 1000)
-        m_size = MAXMESSAGEDATA / 1000;
-    else
-        m_size = MAXMESSAGEDATA / priority;
+    CoalesceRead* read = NULL;
+    Mesg* msg;
+    ssize_t n;
+    int count = 0;
+    int i;
 
-    char buf[m_size];
+    for(i = 0; i < COALESCE_READS && read == NULL; i++)
+    {
+        if(reads[i].child == child)
+            read = &reads[i];
+    }
 
-    snd.mesg_type = msg_type;
-    // Priority is organized by dividing the message by its priority number.
+    if(read == NULL)
+    {
+        return 0;
+    }
 
-    while((i = fread(buf, sizeof(char), (sizeof(buf)/sizeof(char)) -1, fp)) && 
-        !quit)
+    // Sent after the child stopped taking them, each is answered on its own.
+    if((msg = CreateMessage()) != NULL)
     {
-        buf[i] = '\0';
-        strcpy(snd.mesg_data, buf);
+        while((n = recv(read->join[0], &msg->mesg_id, MESGSIZE(messageData),
+            MSG_DONTWAIT)) >= 0)
+        {
+            // The empty one is the child's own, telling it to stop.
+            if(n == 0 || ReceivedMessage(msg, n) < 0)
+                continue;
 
-        if(SendMessage(queue, &snd) < 0){
-            break;
+            fflush(stdout);
+            if((child = fork()) == 0)
+            {
+                ProcessClient(msg, msgQueue);
+                exit(1);
+            }
+            else if(child > 0)
+            {
+                activeChildren++;
+                count++;
+            }
         }
 
+        free(msg);
     }
-    printf("Sending to %ld complete...\n", msg_type);
 
-    SendFinalMessage(queue, &snd) < 0);
-        
-    fclose(fp);
+    close(read->join[0]);
+    close(read->join[1]);
+    read->child = 0;
+
+    return count;
+}
+
+int ReadCoalesceKey(Mesg* msg, CoalesceKey* key)
+{
+    RequestOptions opts;
+    char name[BUFF];
+    struct stat st;
+    pid_t client;
+
+    memset(key, 0, sizeof(CoalesceKey));
+
+    if(traceDir != NULL ||
+        DesignatePriority(msg->mesg_data, name, &key->priority, &client) < 0)
+    {
+        return -1;
+    }
+
+    ReadRequestOptions(msg->mesg_data, &opts);
+    if(!PlainRequest(&opts))
+    {
+        return -1;
+    }
+
+    if(stat(name, &st) < 0 || !S_ISREG(st.st_mode))
+    {
+        return -1;
+    }
+
+    key->usable = 1;
+    key->dev = st.st_dev;
+    key->ino = st.st_ino;
+    key->size = st.st_size;
+    key->mtime = st.st_mtim;
 
     return 0;
 }
 
+int ServeCoalesced(Mesg** requests, int count, const int* join)
+{
+    CoalesceGroup group;
+    CoalesceMember* m;
+    CoalesceMember* slowest;
+    FileSource src;
+    CacheEntry* entry;
+    struct mq_attr attr;
+    sigset_t block;
+    sigset_t old;
+    pthread_t joins;
+    Mesg* spare;
+    Mesg* chunk;
+    pid_t client;
+    long newest;
+    int joining = 0;
+    int slot;
+    int i;
+
+    memset(&group, 0, sizeof(CoalesceGroup));
+    DesignatePriority(requests[0]->mesg_data, group.name, &group.priority,
+        &client);
+
+    spare = CreateMessage();
+    for(i = 0; i < COALESCE_LAG && spare != NULL; i++)
+    {
+        if((group.ring[i] = CreateMessage()) == NULL)
+            break;
+    }
+
+    // Every member asked for the same file, any of their names opens it.
+    if(i < COALESCE_LAG ||
+        (group.file = OpenCachedFile(group.name, &entry)) == NULL)
+    {
+        for(i = 0; i < COALESCE_LAG; i++)
+        {
+            free(group.ring[i]);
+        }
+        free(spare);
+
+        // The file went away since it was grouped, answer each on its own.
+        for(i = 0; i < count; i++)
+        {
+            ProcessClient(requests[i], msgQueue);
+        }
+        return 0;
+    }
+
+    // A cached file has no descriptor, late members copy from the cache.
+    if(entry != NULL)
+    {
+        group.data = CacheData(cache, entry);
+        group.length = entry->size;
+    }
+
+    group.size = ChunkSize(group.priority);
+    group.join = (join != NULL) ? join[0] : -1;
+    pthread_mutex_init(&group.lock, NULL);
+    pthread_cond_init(&group.readable, NULL);
+    pthread_cond_init(&group.room, NULL);
+
+    printf("Sending %s to %d clients at once\n", group.name, count);
+    for(i = 0; i < count; i++)
+    {
+        if(AddMember(&group, requests[i]) < 0)
+            ProcessClient(requests[i], msgQueue);
+    }
+
+    // Requests for the file which arrive later are added as they come.
+    if(join != NULL)
+    {
+        sigemptyset(&block);
+        sigaddset(&block, SIGINT);
+        sigaddset(&block, SIGCHLD);
+        pthread_sigmask(SIG_BLOCK, &block, &old);
+
+        joining = (pthread_create(&joins, NULL, RunJoins, &group) == 0);
+
+        pthread_sigmask(SIG_SETMASK, &old, NULL);
+    }
+
+    OpenSource(&src, group.file);
+
+    // Each chunk is read once, the members each send it on their own.
+    pthread_mutex_lock(&group.lock);
+    while(!quit)
+    {
+        if(group.active == 0)
+        {
+            if(!joining)
+                break;
+
+            // Whoever joined before the Server was told still has to be sent.
+            pthread_mutex_unlock(&group.lock);
+            send(join[1], NULL, 0, 0);
+            pthread_join(joins, NULL);
+            joining = 0;
+            pthread_mutex_lock(&group.lock);
+            continue;
+        }
+
+        slowest = NULL;
+        newest = 0;
+        for(m = group.members; m != NULL; m = m->next)
+        {
+            if(!m->done && m->attached &&
+                (slowest == NULL || m->sent < slowest->sent))
+                slowest = m;
+            if(!m->done && m->attached && m->sent > newest)
+                newest = m->sent;
+        }
+
+        if(group.eof || (slowest != NULL &&
+            group.loaded - slowest->sent >= COALESCE_LAG))
+        {
+            // Too far behind, it goes on from the file rather than stall the
+            // group. A shared SysV queue is full for every member alike.
+            if(!group.eof && newest - slowest->sent >= COALESCE_LAG &&
+                (posix || slowest->queue != msgQueue))
+            {
+                slowest->attached = 0;
+                slowest->behind = 1;
+                printf("client:%d fell behind, sending it the rest alone\n",
+                    slowest->client);
+            }
+            else
+                pthread_cond_wait(&group.room, &group.lock);
+
+            continue;
+        }
+        pthread_mutex_unlock(&group.lock);
+
+        spare->mesg_len = ReadChunk(&src, spare->mesg_data, group.size);
+
+        pthread_mutex_lock(&group.lock);
+        if(spare->mesg_len > 0)
+        {
+            slot = group.loaded % COALESCE_LAG;
+            chunk = group.ring[slot];
+            group.ring[slot] = spare;
+            group.at[slot] = group.offset;
+            spare = chunk;
+
+            group.offset += group.ring[slot]->mesg_len;
+            group.loaded++;
+        }
+        else
+            group.eof = 1;
+
+        pthread_cond_broadcast(&group.readable);
+    }
+
+    if(quit)
+    {
+        // Told to quit, whoever is left is ended short.
+        spare->mesg_len = 0;
+        for(m = group.members; m != NULL; m = m->next)
+        {
+            if(m->done)
+                continue;
+
+            m->done = 1;
+            if(posix)
+            {
+                memset(&attr, 0, sizeof(attr));
+                attr.mq_flags = O_NONBLOCK;
+                mq_setattr(m->queue, &attr, NULL);
+            }
+
+            spare->mesg_type = m->client;
+            spare->mesg_id = m->request;
+            SendReplyNoWait(m->queue, spare, group.priority);
+            StatsTransfer(stats, -1);
+        }
+        pthread_mutex_unlock(&group.lock);
+
+        // The members may still be sending, the exit ends them.
+        printf("Sending to %d clients complete...\n", group.served);
+        return -1;
+    }
+    pthread_mutex_unlock(&group.lock);
+
+    while((m = group.members) != NULL)
+    {
+        pthread_join(m->thread, NULL);
+        group.members = m->next;
+        free(m->snd);
+        free(m);
+    }
+
+    printf("Sending to %d clients complete...\n", group.served);
+
+    CloseSource(&src);
+    fclose(group.file);
+    if(entry != NULL)
+        CacheClose(cache, entry);
+
+    for(i = 0; i < COALESCE_LAG; i++)
+    {
+        free(group.ring[i]);
+    }
+    free(spare);
+
+    pthread_cond_destroy(&group.room);
+    pthread_cond_destroy(&group.readable);
+    pthread_mutex_destroy(&group.lock);
+
+    return (group.served > 0) ? 0 : -1;
+}
+
+int AddMember(CoalesceGroup* group, Mesg* request)
+{
+    CoalesceMember* m;
+    RequestOptions opts;
+    char name[BUFF];
+    sigset_t block;
+    sigset_t old;
+    int priority;
+    int result;
+
+    if((m = calloc(1, sizeof(CoalesceMember))) == NULL)
+    {
+        return -1;
+    }
+
+    if((m->snd = CreateMessage()) == NULL)
+    {
+        free(m);
+        return -1;
+    }
+
+    DesignatePriority(request->mesg_data, name, &priority, &m->client);
+    ReadRequestOptions(request->mesg_data, &opts);
+
+    m->group = group;
+    m->request = request->mesg_id;
+    m->queue = (!posix && opts.queue >= 0) ? opts.queue : msgQueue;
+    m->snd->mesg_type = m->client;
+    m->snd->mesg_id = m->request;
+
+    // Opened blocking, a full queue only holds back the member's own thread.
+    if(posix && (m->queue = OpenClientPosixQueue(m->client, O_WRONLY, 0))
+        == (mqd_t)-1)
+    {
+        free(m->snd);
+        free(m);
+        return -1;
+    }
+
+    // The signals are for the thread reading the file.
+    sigemptyset(&block);
+    sigaddset(&block, SIGINT);
+    sigaddset(&block, SIGCHLD);
+    pthread_sigmask(SIG_BLOCK, &block, &old);
+
+    pthread_mutex_lock(&group->lock);
+    m->attached = (group->loaded <= COALESCE_LAG);
+    if((result = pthread_create(&m->thread, NULL, RunMember, m)) == 0)
+    {
+        m->next = group->members;
+        group->members = m;
+        group->active++;
+    }
+    pthread_mutex_unlock(&group->lock);
+
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    if(result != 0)
+    {
+        if(posix)
+            mq_close(m->queue);
+        free(m->snd);
+        free(m);
+        return -1;
+    }
+
+    StatsRequest(stats);
+    StatsTransfer(stats, 1);
+    return 0;
+}
+
+/* Sends one member the file, from the ring while it keeps up. */
+static void* RunMember(void* arg)
+{
+    CoalesceMember* m = arg;
+    CoalesceGroup* group = m->group;
+    Mesg* snd = m->snd;
+    Mesg* chunk;
+    off_t until;
+    size_t want;
+    long first;
+    int gone = 0;       // Its queue failed
+    int cut = 0;        // The file ended short
+
+    pthread_mutex_lock(&group->lock);
+    while(!quit && !gone && !cut)
+    {
+        first = (group->loaded > COALESCE_LAG) ?
+            group->loaded - COALESCE_LAG : 0;
+
+        if(m->sent < first)
+        {
+            // Joined late or fell behind, what left the ring comes from the
+            // file up to the oldest chunk still in it.
+            m->attached = 0;
+            until = group->at[first % COALESCE_LAG];
+            pthread_mutex_unlock(&group->lock);
+
+            while(!quit && !gone && !cut && m->offset < until)
+            {
+                want = (until - m->offset < (off_t)group->size) ?
+                    (size_t)(until - m->offset) : group->size;
+
+                if(ReadGroupFile(group, snd->mesg_data, want, m->offset)
+                    != want)
+                {
+                    cut = 1;
+                    break;
+                }
+
+                snd->mesg_len = want;
+                gone = (SendReply(m->queue, snd, group->priority) < 0);
+                m->offset += want;
+            }
+
+            pthread_mutex_lock(&group->lock);
+            m->sent = first;
+        }
+        else if(m->sent < group->loaded)
+        {
+            chunk = group->ring[m->sent % COALESCE_LAG];
+            m->attached = !m->behind;
+            snd->mesg_len = chunk->mesg_len;
+            memcpy(snd->mesg_data, chunk->mesg_data, chunk->mesg_len);
+            pthread_mutex_unlock(&group->lock);
+
+            gone = (SendReply(m->queue, snd, group->priority) < 0);
+
+            pthread_mutex_lock(&group->lock);
+            m->sent++;
+            m->offset += snd->mesg_len;
+            pthread_cond_signal(&group->room);
+        }
+        else if(group->eof)
+            break;
+        else
+            pthread_cond_wait(&group->readable, &group->lock);
+    }
+
+    // Already ended short by Serve Coalesced.
+    if(m->done)
+    {
+        pthread_mutex_unlock(&group->lock);
+        return NULL;
+    }
+    m->done = 1;
+    pthread_mutex_unlock(&group->lock);
+
+    // A Client whose queue failed is not there for the end.
+    if(!gone)
+    {
+        snd->mesg_len = 0;
+        if(quit)
+            SendReplyNoWait(m->queue, snd, group->priority);
+        else
+            SendReply(m->queue, snd, group->priority);
+    }
+
+    if(posix)
+        mq_close(m->queue);
+    StatsTransfer(stats, -1);
+
+    pthread_mutex_lock(&group->lock);
+    group->active--;
+    if(!gone && !cut)
+        group->served++;
+    pthread_cond_signal(&group->room);
+    pthread_mutex_unlock(&group->lock);
+
+    return NULL;
+}
+
+/* Adds the requests the Server joins to the read, until it is closed. */
+static void* RunJoins(void* arg)
+{
+    CoalesceGroup* group = arg;
+    Mesg* request;
+    ssize_t n;
+
+    if((request = CreateMessage()) == NULL)
+    {
+        return NULL;
+    }
+
+    // Up to the empty message sent once nobody is left.
+    while((n = recv(group->join, &request->mesg_id, MESGSIZE(messageData),
+        0)) > 0)
+    {
+        if(ReceivedMessage(request, n) < 0)
+            continue;
+
+        if(AddMember(group, request) == 0)
+            printf("A client joined the read of %s\n", group->name);
+        else
+            ProcessClient(request, msgQueue);
+    }
+
+    free(request);
+    return NULL;
+}
+
+/* Reads the file where the ring no longer has it, from the cache if cached. */
+static size_t ReadGroupFile(CoalesceGroup* group, char* where, size_t size,
+                            off_t at)
+{
+    ssize_t n;
+
+    if(group->data != NULL)
+    {
+        if(at >= group->length)
+            return 0;
+
+        if((off_t)size > group->length - at)
+            size = group->length - at;
+
+        memcpy(where, group->data + at, size);
+        return size;
+    }
+
+    n = pread(fileno(group->file), where, size, at);
+    return (n > 0) ? (size_t)n : 0;
+}
+
+void ReapChildren(int block)
+{
+    pid_t child;
+
+    // Only the Server's own process group, the statistics dump has its own.
+    while((child = waitpid(0, NULL, block ? 0 : WNOHANG)) > 0)
+    {
+        activeChildren--;
+        block = 0;
+
+        if(coalesce)
+            EndCoalescedRead(child);
+    }
+}
+
+int RunWorkerPool(void)
+{
+    pid_t pool[MAXWORKERS];
+    pid_t pid;
+    int status;
+    int i;
+
+    for(i = 0; i < workers; i++)
+    {
+        pool[i] = SpawnWorker();
+    }
+
+    while(!quit)
+    {
+        if((pid = waitpid(-1, &status, 0)) < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            break;
+        }
+
+        for(i = 0; i < workers; i++)
+        {
+            if(pool[i] != pid)
+                continue;
+
+            // Workers only leave on quit, anything else was a crash.
+            pool[i] = -1;
+            if(!quit)
+            {
+                printf("Worker %d stopped, starting another.\n", pid);
+                pool[i] = SpawnWorker();
+            }
+        }
+    }
+
+    for(i = 0; i < workers; i++)
+    {
+        if(pool[i] > 0)
+            kill(pool[i], SIGINT);
+    }
+
+    // Only the workers, the statistics dump is stopped by the Server.
+    for(i = 0; i < workers; i++)
+    {
+        while(pool[i] > 0 && waitpid(pool[i], NULL, 0) < 0 && errno == EINTR)
+        {
+        }
+    }
+
+    return 0;
+}
+
+int RunThreadPool(void)
+{
+    ThreadPool* pool;
+    Mesg* rcv;
+
+    if((pool = CreateThreadPool(threads, msgQueue, ProcessClient)) == NULL)
+    {
+        printf("Cannot start the thread pool.\n");
+        return 1;
+    }
+
+    // This thread only dispatches, the workers serve the requests.
+    while(!quit)
+    {
+        if((rcv = CreateMessage()) == NULL)
+            break;
+
+        if(ReadRequest(msgQueue, rcv) < 0 || SubmitTask(pool, rcv) < 0)
+        {
+            free(rcv);
+        }
+    }
+
+    DestroyThreadPool(pool);
+    return 0;
+}
+
+pid_t SpawnWorker(void)
+{
+    pid_t worker;
+    Mesg* rcv;
+
+    fflush(stdout);
+    if((worker = fork()) != 0)
+    {
+        if(worker < 0)
+            printf("Cannot start a worker.\n");
+
+        return worker;
+    }
+
+    if((rcv = CreateMessage()) == NULL)
+    {
+        exit(1);
+    }
+
+    // Each worker takes requests straight off of the queue.
+    while(!quit)
+    {
+        if(ReadRequest(msgQueue, rcv) == 0)
+        {
+            ProcessClient(rcv, msgQueue);
+        }
+    }
+
+    free(rcv);
+
+    exit(0);
+}
+
+int ProcessClient(Mesg* msg, int queue)
+{
+    FILE* file;
+    CacheEntry* entry;
+    char name[BUFF];
+    pid_t client;
+    int priority;
+    int result = 0;
+    RequestOptions opts;
+    Credit credit;
+    Trace* trace = NULL;
+
+    if(DesignatePriority(msg->mesg_data, name, &priority, &client) < 0)
+    {
+        printf("Fatal error, cannot read message.");
+        return -1;
+    }
+
+    ReadRequestOptions(msg->mesg_data, &opts);
+    StatsRequest(stats);
+
+    // The file bypasses the message queue when the client sent a ring.
+    if(opts.ring >= 0)
+    {
+        StatsTransfer(stats, 1);
+        result = StreamToRing(name, client, opts.ring);
+        StatsTransfer(stats, -1);
+        return result;
+    }
+
+    // The client reads the file itself when it asked for the descriptor.
+    if(opts.fd)
+    {
+        return DeliverDescriptor(name, client);
+    }
+
+    // A slow client only fills its own queue when it brought one.
+    if(!posix && opts.queue >= 0)
+    {
+        queue = opts.queue;
+    }
+
+    // Each client owns its reply queue on the POSIX backend.
+    if(posix && 
+        (queue = OpenClientPosixQueue(client, O_WRONLY, 0)) == (mqd_t)-1)
+    {
+        printf("Cannot open the queue of client:%d\n", client);
+        return -1;
+    }
+
+    // Asking for the statistics is not a transfer of its own.
+    if(!opts.stats)
+        StatsTransfer(stats, 1);
+
+    // A compressed chunk is not a piece of the file, only plain ones are traced.
+    if(traceDir != NULL && !opts.stats && !opts.zip)
+    {
+        trace = OpenTrace(traceDir, TRACE_SERVER, client, msg->mesg_id);
+    }
+
+    if(OpenCredit(&credit, queue, client, opts.credit) < 0)
+    {
+        result = -1;
+    }
+    else if(opts.stats)
+    {
+        result = SendStats(queue, client, msg->mesg_id, priority);
+    }
+    else if(opts.batch)
+    {
+        result = ProcessBatch(name, queue, client, msg->mesg_id, priority,
+            &credit, trace);
+    }
+    else if((file = OpenCachedFile(name, &entry)) == NULL)
+    {
+        msg->mesg_type = client;
+        msg->mesg_len = sprintf(msg->mesg_data, "Cannot open file: %s\n", name);
+        if(SendReply(queue, msg, priority) < 0)
+        {
+            result = -1;
+        }
+        else
+        {
+            msg->mesg_len = 0;
+            if(SendReply(queue, msg, priority) < 0)
+            {
+                result = -1;
+            }
+        }
+    }
+    else
+    {
+        printf("Sending %s to client:%d\n", name, client);
+        if(opts.zip)
+            PacketizeCompressed(file, queue, (long)client, msg->mesg_id,
+                priority, &credit);
+        else
+            PacketizeData(file, queue, (long)client, msg->mesg_id, priority,
+                &credit, trace);
+
+        if(entry != NULL)
+            CacheClose(cache, entry);
+    }
+
+    CloseCredit(&credit);
+    CloseTrace(trace);
+    if(!opts.stats)
+        StatsTransfer(stats, -1);
+
+    // Workers serve many clients, the reply queue must not be kept open.
+    if(posix)
+    {
+        mq_close(queue);
+    }
+
+    return result;
+}
+
+FILE* OpenCachedFile(const char* name, CacheEntry** entry)
+{
+    FILE* fp;
+
+    *entry = NULL;
+    if(cache != NULL && (*entry = CacheOpen(cache, name)) != NULL)
+    {
+        // The transfer reads the cached contents as if it were the file.
+        if((fp = fmemopen((void*)CacheData(cache, *entry), (*entry)->size,
+            "r")) != NULL)
+        {
+            return fp;
+        }
+
+        CacheClose(cache, *entry);
+        *entry = NULL;
+    }
+
+    return OpenFile(name);
+}
+
+int DesignatePriority(const char* text,
+                      char* name,
+                      int* priority,
+                      pid_t* client)
+{
+
+    int n = sscanf(text, "%s %d %d", name, priority, client);
+    
+    if (n == 3)
+    {
+        return 1;
+    }
+
+    return -1;
+}
+
+int ReadRequestOptions(const char* text, RequestOptions* opts)
+{
+    char option[BUFF];
+    int offset = 0;
+    int n;
+
+    opts->ring = -1;
+    opts->fd = 0;
+    opts->queue = -1;
+    opts->batch = 0;
+    opts->zip = 0;
+    opts->credit = 0;
+    opts->stats = 0;
+
+    // Skip over the "name priority pid" handled by DesignatePriority.
+    if(sscanf(text, "%*s %*d %*d%n", &offset) < 0 || offset == 0)
+    {
+        return -1;
+    }
+    text += offset;
+
+    while(sscanf(text, "%255s%n", option, &n) == 1)
+    {
+        text += n;
+
+        if(sscanf(option, "ring=%d", &opts->ring) == 1)
+            continue;
+
+        if(sscanf(option, "fd=%d", &opts->fd) == 1)
+            continue;
+
+        if(sscanf(option, "queue=%d", &opts->queue) == 1)
+            continue;
+
+        if(sscanf(option, "batch=%d", &opts->batch) == 1)
+            continue;
+
+        if(sscanf(option, "zip=%d", &opts->zip) == 1)
+            continue;
+
+        if(sscanf(option, "credit=%ld", &opts->credit) == 1)
+            continue;
+
+        if(sscanf(option, "stats=%d", &opts->stats) == 1)
+            continue;
+    }
+
+    return 0;
+}
+
+int PlainRequest(const RequestOptions* opts)
+{
+    return opts->ring < 0 && !opts->fd && !opts->batch && !opts->zip &&
+        !opts->credit && !opts->stats;
+}
+
+int StreamToRing(const char* name, pid_t client, int shmid)
+{
+    Ring* ring;
+    char* where;
+    size_t space;
+    ssize_t n;
+    int fd;
+
+    if((ring = AttachRing(shmid)) == NULL)
+    {
+        printf("Cannot attach the ring of client:%d\n", client);
+        return -1;
+    }
+
+    if((fd = open(name, O_RDONLY)) < 0)
+    {
+        if((space = RingWriteSpace(ring, &where)) > 0)
+        {
+            n = snprintf(where, space, "Cannot open file: %s\n", name);
+            RingCommit(ring, ((size_t)n < space) ? (size_t)n : space);
+        }
+    }
+    else
+    {
+        printf("Sending %s to client:%d\n", name, client);
+
+        // The file is read straight into the client's ring.
+        while(!quit && (space = RingWriteSpace(ring, &where)) > 0)
+        {
+            if((n = read(fd, where, space)) <= 0)
+                break;
+
+            RingCommit(ring, n);
+            StatsSent(stats, n, 0);
+        }
+
+        printf("Sending to %d complete...\n", client);
+        close(fd);
+    }
+
+    RingClose(ring);
+    DetachRing(ring);
+
+    return 0;
+}
+
+int DeliverDescriptor(const char* name, pid_t client)
+{
+    char text[BUFF + 32];
+    struct stat st;
+    int fd;
+    int result;
+
+    // Only regular files can be sent or mapped by the client.
+    if((fd = open(name, O_RDONLY)) < 0 || fstat(fd, &st) < 0 ||
+        !S_ISREG(st.st_mode))
+    {
+        if(fd >= 0)
+            close(fd);
+
+        result = snprintf(text, sizeof(text), "Cannot open file: %s\n", name);
+        return SendDescriptor(client, -1, text, result);
+    }
+
+    printf("Sending %s to client:%d\n", name, client);
+    result = SendDescriptor(client, fd, "", 1);
+    close(fd);
+
+    if(result < 0)
+    {
+        printf("Cannot reach client:%d\n", client);
+        return -1;
+    }
+
+    printf("Sending to %d complete...\n", client);
+    return 0;
+}
+
+int PacketizeData(FILE* fp,
+                  const int queue,
+                  const long msg_type,
+                  const long request,
+                  const int priority,
+                  Credit* credit,
+                  Trace* trace)
+{
+    Mesg* snd;
+
+    if((snd = CreateMessage()) == NULL)
+    {
+        fclose(fp);
+        return -1;
+    }
+
+    snd->mesg_type = msg_type;
+    snd->mesg_id = request;
+    SendContents(fp, snd, queue, priority, -1, credit, trace);
+    printf("Sending to %ld complete...\n", msg_type);
+
+    snd->mesg_len = 0;
+    snd->mesg_seq = 0;
+    SendReply(queue, snd, priority);
+        
+    free(snd);
+    fclose(fp);
+
+    return 0;
+}
+
+int SendContents(FILE* fp, Mesg* snd, int queue, int priority, off_t limit,
+                 Credit* credit, Trace* trace)
+{
+    TraceRecord record;
+    FileSource src;
+    ReadAhead* ahead = NULL;
+    Mesg* chunk = snd;
+    size_t largest = messageData;
+    size_t m_size;
+    size_t want;
+    int result = 0;
+
+    // A traced chunk leaves room for the stamp queued after it.
+    if(trace != NULL)
+        largest -= MESGSTAMP;
+
+    OpenSource(&src, fp);
+    if((m_size = ChunkSize(priority)) > largest)
+        m_size = largest;
+
+    // The reader fills the next chunks while this one is sent.
+    if(readAhead && src.map == NULL && fileno(fp) >= 0)
+    {
+        ahead = StartReadAhead(&src, m_size, limit);
+    }
+
+    // The file is read straight into the message, binary data included.
+    while(!quit && limit != 0)
+    {
+        if(ahead != NULL)
+        {
+            if((chunk = TakeAhead(ahead, &record)) == NULL)
+                break;
+
+            chunk->mesg_type = snd->mesg_type;
+            chunk->mesg_id = snd->mesg_id;
+        }
+        else
+        {
+            want = m_size;
+            if(limit > 0 && (off_t)want > limit)
+                want = limit;
+
+            if(trace != NULL)
+                record.start = MonotonicNs();
+
+            if((snd->mesg_len = ReadChunk(&src, snd->mesg_data, want)) == 0)
+            {
+                if(limit < 0)
+                    break;
+
+                // The file shrank after it was measured, keep to the framing.
+                memset(snd->mesg_data, 0, want);
+                snd->mesg_len = want;
+            }
+
+            if(trace != NULL)
+                record.stage = MonotonicNs() - record.start;
+        }
+
+        if(limit > 0)
+            limit -= chunk->mesg_len;
+
+        if(trace != NULL)
+            chunk->mesg_seq = ++snd->mesg_seq;
+
+        if(SendWithCredit(queue, chunk, priority, credit) < 0){
+            result = -1;
+            break;
+        }
+
+        if(trace != NULL)
+        {
+            record.seq = chunk->mesg_seq;
+            record.len = chunk->mesg_len;
+            record.sent = chunk->mesg_sent;
+            record.blocked = MonotonicNs() - chunk->mesg_sent;
+            TraceChunk(trace, &record);
+        }
+
+        // Nobody is waiting behind a drained queue, send more at once.
+        if(adaptive && m_size < largest && ReplyBacklog(queue) == 0)
+        {
+            m_size = (m_size * 2 < largest) ? m_size * 2 : largest;
+            if(ahead != NULL)
+                ResizeAhead(ahead, m_size);
+        }
+
+    }
+
+    StopReadAhead(ahead);
+    CloseSource(&src);
+    return result;
+}
+
+size_t ChunkSize(int priority)
+{
+    // Priority is organized by dividing the message by its priority number.
+    if (priority < 1)
+        return messageData;
+    else if (priority > 1000)
+        return messageData / 1000;
+
+    return messageData / priority;
+}
+
+#ifndef USE_ZLIB
+int PacketizeCompressed(FILE* fp,
+                        const int queue,
+                        const long msg_type,
+                        const long request,
+                        const int priority,
+                        Credit* credit)
+{
+    // Built without zlib, the Client is told to expect the plain file.
+    if(AnswerCompression(queue, msg_type, request, priority, 0) < 0)
+    {
+        fclose(fp);
+        return -1;
+    }
+
+    return PacketizeData(fp, queue, msg_type, request, priority, credit, NULL);
+}
+#else
+int PacketizeCompressed(FILE* fp,
+                        const int queue,
+                        const long msg_type,
+                        const long request,
+                        const int priority,
+                        Credit* credit)
+{
+    FileSource src;
+    z_stream zs;
+    Mesg* snd;
+    char* raw;
+    size_t m_size = ChunkSize(priority);
+    size_t used = 0;
+    size_t n;
+    int flush;
+    int status = Z_OK;
+
+    snd = CreateMessage();
+    raw = malloc(m_size * ZIP_READ_SCALE);
+    memset(&zs, 0, sizeof(zs));
+
+    if(snd == NULL || raw == NULL || deflateInit(&zs, ZIP_LEVEL) != Z_OK)
+    {
+        free(snd);
+        free(raw);
+
+        if(AnswerCompression(queue, msg_type, request, priority, 0) < 0)
+        {
+            fclose(fp);
+            return -1;
+        }
+
+        return PacketizeData(fp, queue, msg_type, request, priority, credit,
+            NULL);
+    }
+
+    snd->mesg_type = msg_type;
+    snd->mesg_id = request;
+    AnswerCompression(queue, msg_type, request, priority, 1);
+    OpenSource(&src, fp);
+
+    // The messages are filled from the one stream, all full but the last.
+    do
+    {
+        n = quit ? 0 : ReadChunk(&src, raw, m_size * ZIP_READ_SCALE);
+        flush = (n == 0) ? Z_FINISH : Z_NO_FLUSH;
+        zs.next_in = (Bytef*)raw;
+        zs.avail_in = n;
+
+        do
+        {
+            zs.next_out = (Bytef*)snd->mesg_data + used;
+            zs.avail_out = m_size - used;
+            status = deflate(&zs, flush);
+            used = m_size - zs.avail_out;
+
+            if(used == m_size || (status == Z_STREAM_END && used > 0))
+            {
+                snd->mesg_len = used;
+                used = 0;
+                if(SendWithCredit(queue, snd, priority, credit) < 0)
+                {
+                    status = Z_STREAM_ERROR;
+                    break;
+                }
+            }
+        } while(zs.avail_in > 0 || (flush == Z_FINISH && status == Z_OK));
+
+    } while(flush != Z_FINISH && status != Z_STREAM_ERROR);
+
+    printf("Sending to %ld complete, %lu bytes in %lu...\n", msg_type,
+        zs.total_in, zs.total_out);
+    deflateEnd(&zs);
+    CloseSource(&src);
+
+    snd->mesg_len = 0;
+    SendReply(queue, snd, priority);
+
+    free(raw);
+    free(snd);
+    fclose(fp);
+
+    return 0;
+}
+#endif
+
+int AnswerCompression(int queue, long msg_type, long request, int priority,
+                      int accepted)
+{
+    Mesg* snd;
+    int result;
+
+    if((snd = CreateMessage()) == NULL)
+    {
+        return -1;
+    }
+
+    snd->mesg_type = msg_type;
+    snd->mesg_id = request;
+    snd->mesg_len = sprintf(snd->mesg_data, "zip=%d", accepted);
+    result = SendReply(queue, snd, priority);
+
+    free(snd);
+    return result;
+}
+
+int OpenCredit(Credit* credit, int queue, pid_t client, long window)
+{
+    credit->queue = queue;
+    credit->type = CREDIT_TYPE(client);
+    credit->available = -1;
+    credit->grant = NULL;
+
+    // The grants come back on the reply queue, only SysV has one to share.
+    if(window <= 0 || posix)
+    {
+        return 0;
+    }
+
+    if((credit->grant = CreateMessage()) == NULL)
+    {
+        return -1;
+    }
+
+    credit->available = window;
+    return 0;
+}
+
+int TakeCredit(Credit* credit)
+{
+    if(credit == NULL || credit->available < 0)
+    {
+        return 0;
+    }
+
+    // The Client grants more as it writes out the chunks it has.
+    while(credit->available == 0)
+    {
+        if(quit || ReadMessage(credit->queue, credit->grant, credit->type) < 0)
+        {
+            if(!quit && errno == EINTR)
+                continue;
+            return -1;
+        }
+
+        credit->available += atol(credit->grant->mesg_data);
+    }
+
+    credit->available--;
+    return 0;
+}
+
+int SendWithCredit(int queue, Mesg* msg, int priority, Credit* credit)
+{
+    if(TakeCredit(credit) < 0)
+    {
+        return -1;
+    }
+
+    return SendReply(queue, msg, priority);
+}
+
+void CloseCredit(Credit* credit)
+{
+    // Grants sent after the last chunk would fill the shared queue for good.
+    if(credit->grant != NULL)
+    {
+        while(ReadMessageNoWait(credit->queue, credit->grant, credit->type)
+            == 0)
+        {
+        }
+    }
+
+    free(credit->grant);
+    credit->grant = NULL;
+}
+
+int ProcessBatch(const char* pattern, int queue, pid_t client, long request,
+                 int priority, Credit* credit, Trace* trace)
+{
+    char spec[BUFF + 2];
+    struct stat st;
+    glob_t found;
+    CacheEntry* entry;
+    FILE* file;
+    Mesg* snd;
+    off_t size;
+    size_t i;
+    int files = 0;
+    int result = 0;
+
+    if((snd = CreateMessage()) == NULL)
+    {
+        return -1;
+    }
+    snd->mesg_type = client;
+    snd->mesg_id = request;
+
+    // A directory stands for every file directly inside of it.
+    if(stat(pattern, &st) == 0 && S_ISDIR(st.st_mode))
+        snprintf(spec, sizeof(spec), "%s/*", pattern);
+    else
+        snprintf(spec, sizeof(spec), "%s", pattern);
+
+    // Without a match the pattern itself is reported as not found.
+    if(glob(spec, GLOB_NOCHECK, NULL, &found) != 0)
+    {
+        found.gl_pathc = 0;
+    }
+
+    printf("Sending %s to client:%d\n", spec, client);
+
+    for(i = 0; i < found.gl_pathc && !quit && result == 0; i++)
+    {
+        if(stat(found.gl_pathv[i], &st) == 0 && S_ISDIR(st.st_mode))
+            continue;
+
+        size = -1;
+        if((file = OpenCachedFile(found.gl_pathv[i], &entry)) != NULL)
+        {
+            fseeko(file, 0, SEEK_END);
+            size = ftello(file);
+            rewind(file);
+        }
+
+        snd->mesg_len = snprintf(snd->mesg_data, messageData, "%lld %s",
+            (long long)size, found.gl_pathv[i]);
+        if(snd->mesg_len >= messageData)
+            snd->mesg_len = messageData - 1;
+
+        if(SendReply(queue, snd, priority) < 0)
+            result = -1;
+        else if(file != NULL && size > 0)
+            result = SendContents(file, snd, queue, priority, size, credit,
+                trace);
+
+        if(file != NULL)
+        {
+            fclose(file);
+            files++;
+        }
+
+        if(entry != NULL)
+            CacheClose(cache, entry);
+    }
+
+    printf("Sending %d files to %d complete...\n", files, client);
+    globfree(&found);
+
+    snd->mesg_len = 0;
+    if(SendReply(queue, snd, priority) < 0)
+        result = -1;
+
+    free(snd);
+    return result;
+}
+
+void OpenSource(FileSource* src, FILE* fp)
+{
+    struct stat st;
+    void* map;
+
+    memset(src, 0, sizeof(FileSource));
+    src->fp = fp;
+    src->fd = -1;
+
+    // Cached files are streams in memory and have no descriptor.
+    if((!mapped && !uring) || (src->fd = fileno(fp)) < 0)
+        return;
+
+    if(fstat(src->fd, &st) < 0 || !S_ISREG(st.st_mode) || st.st_size == 0)
+        return;
+
+    if(!mapped)
+    {
+        if((src->uring = OpenUringReader(src->fd, 0, messageData)) == NULL)
+            posix_fadvise(src->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        return;
+    }
+
+    src->size = st.st_size;
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, src->fd, 0);
+    if(map == MAP_FAILED)
+    {
+        posix_fadvise(src->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        return;
+    }
+
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+    src->map = map;
+}
+
+size_t ReadChunk(FileSource* src, char* where, size_t size)
+{
+    sigjmp_buf fault;
+    ssize_t n;
+
+    if(src->map != NULL)
+    {
+        if((off_t)size > src->size - src->offset)
+            size = src->size - src->offset;
+
+        // The only copy made before the kernel's.
+        if(sigsetjmp(fault, 1) == 0)
+        {
+            mapFault = &fault;
+            memcpy(where, src->map + src->offset, size);
+            mapFault = NULL;
+
+            src->offset += size;
+            return size;
+        }
+
+        // The file was cut short, pread finds where it now ends.
+        mapFault = NULL;
+        munmap((void*)src->map, src->size);
+        src->map = NULL;
+    }
+
+    if(src->uring != NULL)
+    {
+        if((n = UringRead(src->uring, where, size)) >= 0)
+        {
+            src->offset += n;
+            return n;
+        }
+
+        // Carry on from the same byte without the ring.
+        CloseUringReader(src->uring);
+        src->uring = NULL;
+    }
+
+    if(src->fd >= 0)
+    {
+        if((n = pread(src->fd, where, size, src->offset)) >= 0)
+        {
+            src->offset += n;
+            return n;
+        }
+
+        // Pipes and the like cannot be read at an offset.
+        src->fd = -1;
+    }
+
+    return fread(where, sizeof(char), size, src->fp);
+}
+
+void CloseSource(FileSource* src)
+{
+    if(src->map != NULL)
+    {
+        munmap((void*)src->map, src->size);
+        src->map = NULL;
+    }
+
+    CloseUringReader(src->uring);
+    src->uring = NULL;
+}
+
+/* Answers a stats=1 request with one line of JSON, then the final message. */
+int SendStats(int queue, long msg_type, long request, int priority)
+{
+    StatsSnapshot now;
+    Mesg* snd;
+    int result;
+
+    if((snd = CreateMessage()) == NULL)
+    {
+        return -1;
+    }
+
+    TakeSnapshot(stats, &now);
+    snd->mesg_type = msg_type;
+    snd->mesg_id = request;
+    snd->mesg_len = FormatStats(snd->mesg_data, messageData - 1, &now, NULL,
+        ReplyBacklog(msgQueue));
+    if(snd->mesg_len >= messageData - 1)
+        snd->mesg_len = messageData - 2;
+    snd->mesg_data[snd->mesg_len++] = '\n';
+
+    if((result = SendReply(queue, snd, priority)) == 0)
+    {
+        snd->mesg_len = 0;
+        result = SendReply(queue, snd, priority);
+    }
+
+    free(snd);
+    return result;
+}
+
+pid_t SpawnStatsDumper(const char* path)
+{
+    StatsSnapshot before;
+    StatsSnapshot now;
+    char line[BUFF * 2];
+    pid_t server = getpid();
+    pid_t dumper;
+    FILE* fp;
+
+    fflush(stdout);
+    if((dumper = fork()) != 0)
+    {
+        if(dumper < 0)
+            printf("Cannot start the statistics dump.\n");
+        else
+            setpgid(dumper, dumper);
+
+        return dumper;
+    }
+
+    // Out of the way of Reap Children, both sides set it to avoid a race.
+    setpgid(0, 0);
+
+    if(strcmp(path, "-") == 0)
+        fp = stdout;
+    else if((fp = fopen(path, "a")) == NULL)
+    {
+        printf("Cannot open %s for the statistics.\n", path);
+        exit(1);
+    }
+
+    TakeSnapshot(stats, &before);
+    while(!quit && getppid() == server)
+    {
+        // Cut short by the signals of the Server, which is harmless.
+        sleep(STATS_INTERVAL);
+
+        TakeSnapshot(stats, &now);
+        FormatStats(line, sizeof(line), &now, &before,
+            ReplyBacklog(msgQueue));
+        fprintf(fp, "%s\n", line);
+        fflush(fp);
+        before = now;
+    }
+
+    fclose(fp);
+    exit(0);
+}
+
+/* Interrupts the wait for requests so that finished children are reaped. */
+void child_handler(int sig)
+{
+    if(sig){
+
+    }
+}
+
+/* Returns to Read Chunk, or crashes as usual outside of a copy. */
+void bus_handler(int sig)
+{
+    if(mapFault != NULL)
+        siglongjmp(*mapFault, 1);
+
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
 /* Simple signal handler */
 void sig_handler(int sig)
 {
@@ -5,18 +5,75 @@ SOURCE FILE:    Server.h
 
 PROGRAM:        Server
 
-FUNCTIONS:      int main(void)
+FUNCTIONS:      int main(int argc, char** argv)
                 int Server(void)
+                int ReadServerArguments(int argc, char** argv)
+                void ServerHelp(void)
+                int ReadRequest(int queue, Mesg* msg)
+                int SendReply(int queue, Mesg* msg, int priority)
+                int ReadRequestNoWait(int queue, Mesg* msg)
+                int SendReplyNoWait(int queue, Mesg* msg, int priority)
+                int ReplyBacklog(int queue)
                 int SearchForClients(void)
+                int DispatchCoalesced(Mesg* first)
+                int ReadCoalesceKey(Mesg* msg, CoalesceKey* key)
+                int JoinCoalescedRead(const CoalesceKey* key,
+                      Mesg** group, int count)
+                int EndCoalescedRead(pid_t child)
+                int ServeCoalesced(Mesg** requests, int count,
+                      const int* join)
+                int AddMember(CoalesceGroup* group, Mesg* request)
+                void ReapChildren(int block)
+                int RunWorkerPool(void)
+                pid_t SpawnWorker(void)
+                int RunThreadPool(void)
                 int ProcessClient(Mesg* msg, int queue)
+                FILE* OpenCachedFile(const char* name, CacheEntry** entry)
                 int DesignatePriority(const char* text,
                       char* name,
                       int* priority,
                       pid_t* client)
+                int ReadRequestOptions(const char* text,
+                      RequestOptions* opts)
+                int PlainRequest(const RequestOptions* opts)
                 int PacketizeData(FILE* fp,
                       const int queue,
                       const long msg_type,
-                      const int priority)
+                      const long request,
+                      const int priority,
+                      Credit* credit,
+                      Trace* trace)
+                int SendContents(FILE* fp, Mesg* snd, int queue,
+                      int priority, off_t limit, Credit* credit,
+                      Trace* trace)
+                size_t ChunkSize(int priority)
+                int PacketizeCompressed(FILE* fp,
+                      const int queue,
+                      const long msg_type,
+                      const long request,
+                      const int priority,
+                      Credit* credit)
+                int AnswerCompression(int queue, long msg_type,
+                      long request, int priority, int accepted)
+                int OpenCredit(Credit* credit, int queue, pid_t client,
+                      long window)
+                int TakeCredit(Credit* credit)
+                int SendWithCredit(int queue, Mesg* msg, int priority,
+                      Credit* credit)
+                void CloseCredit(Credit* credit)
+                int ProcessBatch(const char* pattern, int queue,
+                      pid_t client, long request, int priority,
+                      Credit* credit, Trace* trace)
+                void OpenSource(FileSource* src, FILE* fp)
+                size_t ReadChunk(FileSource* src, char* where, size_t size)
+                void CloseSource(FileSource* src)
+                int StreamToRing(const char* name, pid_t client, int shmid)
+                int DeliverDescriptor(const char* name, pid_t client)
+                int SendStats(int queue, long msg_type, long request,
+                      int priority)
+                pid_t SpawnStatsDumper(const char* path)
+                void child_handler(int sig)
+                void bus_handler(int sig)
                 void sig_handler(int sig)
 
 
@@ -35,6 +92,73 @@ REVISIONS:      January 31, 2016        (Tyler Trepanier-Bracken)
                     Client has their own definitions of the sig_handler
                     with their own implementations.
 
+                October 17, 2026        (agent)
+                    Added the POSIX message queue backend (-P) alongside the
+                    SysV message queue.
+
+                October 17, 2026        (agent)
+                    Clients may send a shared memory ring with their request,
+                    the file is then streamed through the ring instead of the
+                    message queue.
+
+                October 17, 2026        (agent)
+                    Clients may ask for the open file itself, which is passed
+                    over a Unix socket instead of being sent in chunks.
+
+                October 17, 2026        (agent)
+                    Added the pre-forked worker pool (-w) and the limit on
+                    children forked per request (-c). Finished children are
+                    now reaped.
+
+                October 17, 2026        (agent)
+                    Added the multithreaded engine (-t) which serves the
+                    requests from a work-stealing thread pool.
+
+                October 17, 2026        (agent)
+                    Added the deficit round robin scheduler (-s) which turns
+                    the priority into a share of the queue.
+
+                October 17, 2026        (agent)
+                    The chunks are sized by the limits of the queue instead
+                    of MAXMESSAGEDATA and may grow while the reply queue is
+                    drained (-a).
+
+                October 17, 2026        (agent)
+                    Clients may send their own SysV reply queue with their
+                    request.
+
+                October 17, 2026        (agent)
+                    Added the shared content cache (-m) for hot files.
+
+                October 17, 2026        (agent)
+                    Files may be sent from a memory mapping (-M).
+
+                October 17, 2026        (agent)
+                    A request may ask for a batch of files, served by one
+                    worker with each file framed in the reply stream.
+
+                October 17, 2026        (agent)
+                    Every reply carries the mesg_id of its request.
+
+                October 17, 2026        (agent)
+                    Chunks may be sent compressed (zip=1) when the Server
+                    is built with USE_ZLIB.
+
+                October 17, 2026        (agent)
+                    Added credit based flow control (credit=N), no Client
+                    has more than its window of chunks on the queue.
+
+                October 17, 2026        (agent)
+                    Added live statistics, answered to stats=1 requests and
+                    dumped as JSON lines with -j.
+
+                October 17, 2026        (agent)
+                    Added per chunk latency traces (-T).
+
+                October 17, 2026        (agent)
+                    Requests for the same file may share one read of it
+                    (-g), those made while it is read join it.
+
 DESIGNGER:      Tyler Trepanier-Bracken
 
 PROGRAMMER:     Tyler Trepanier-Bracken
@@ -59,6 +183,137 @@ inside of the Utilities files.
 */
 
 #include "Utilities.h"
+#include "PosixQueue.h"
+#include "Ring.h"
+#include "FdPass.h"
+#include "ThreadPool.h"
+#include "Scheduler.h"
+#include "EventLoop.h"
+#include "Cache.h"
+#include "Stats.h"
+#include "Trace.h"
+#include "Uring.h"
+#include "ReadAhead.h"
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <setjmp.h>
+#include <glob.h>
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+
+#define MAXWORKERS      64      // Largest pre-forked worker pool
+#define COALESCE_MAX    64      // Most requests taken off of the queue at once
+#define COALESCE_LAG    64      // Chunks a member may fall behind the fastest
+#define COALESCE_READS  64      // Reads in progress later requests may join
+#define ZIP_LEVEL       1       // zlib level of compressed transfers, fastest
+#define ZIP_READ_SCALE  4       // File bytes read per message of a compressed
+                                // transfer, in chunks
+
+/* Global variables, defined inside of Server.c */
+extern int quit;            // Set once the Server has been told to stop.
+extern int posix;           // Use the POSIX message queues instead of SysV.
+extern int activeChildren;  // Children forked per request which are running.
+extern Cache* cache;        // Contents of the files most recently sent.
+extern Stats* stats;        // Counters shared by every worker.
+extern const char* traceDir;    // Where the transfers are traced, NULL for none.
+
+/*
+Options which may follow the "name priority pid" of a Client's request, each
+written as key=value.
+*/
+typedef struct
+{
+    int ring;           // Shared memory id of the Client's ring, -1 if none.
+    int fd;             // Pass the open file to the Client instead.
+    int queue;          // The Client's own SysV reply queue, -1 if none.
+    int batch;          // The name is a pattern or directory of many files.
+    int zip;            // Send the file through a zlib stream.
+    long credit;        // Chunks the Client allows in flight, 0 for no limit.
+    int stats;          // Answer with the Server's statistics, no file.
+} RequestOptions;
+
+/* Flow control of one transfer, see Take Credit. */
+typedef struct
+{
+    int queue;          // Queue the grants arrive on
+    long type;          // Message type of the grants, CREDIT_TYPE(client)
+    long available;     // Chunks which may still be sent, -1 for no limit
+    Mesg* grant;        // Receives the grants
+} Credit;
+
+/* What makes two requests the same transfer, see Dispatch Coalesced. */
+typedef struct
+{
+    int usable;         // The request may share its transfer
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    struct timespec mtime;
+    int priority;       // Sizes the chunks, only equal ones are shared
+} CoalesceKey;
+
+/* A read in progress which later requests may join, see Join Coalesced Read. */
+typedef struct
+{
+    CoalesceKey key;
+    pid_t child;        // Serving the read, 0 while the slot is free
+    int join[2];        // Requests go in at [1], the child takes them at [0]
+} CoalesceRead;
+
+struct CoalesceGroup;
+
+/* One Client of a coalesced transfer, sent the file by a thread of its own. */
+typedef struct CoalesceMember
+{
+    struct CoalesceGroup* group;
+    struct CoalesceMember* next;
+    pthread_t thread;
+    pid_t client;
+    long request;       // mesg_id of its request
+    int queue;          // Its reply queue
+    Mesg* snd;          // Its copy of the chunk being sent
+    long sent;          // Chunks of the group it has been sent
+    off_t offset;       // Bytes of the file it has been sent
+    int attached;       // The reader keeps its next chunk for it
+    int behind;         // Fell behind, the reader no longer waits for it
+    int done;
+} CoalesceMember;
+
+/* The read shared by the members of a group, in the child serving it. */
+typedef struct CoalesceGroup
+{
+    char name[BUFF];
+    int priority;
+    size_t size;                // Bytes in a chunk
+    FILE* file;
+    const char* data;           // The cached contents, NULL when not cached
+    off_t length;               // Bytes of data
+    Mesg* ring[COALESCE_LAG];   // Chunk n is in ring[n % COALESCE_LAG]
+    off_t at[COALESCE_LAG];     // Where in the file each of those starts
+    long loaded;                // Chunks read from the file
+    off_t offset;               // Bytes of the file in those chunks
+    int eof;
+    CoalesceMember* members;
+    int active;                 // Members not done yet
+    int served;                 // Members sent the whole file
+    int join;                   // Later requests arrive on it, -1 for none
+    pthread_mutex_t lock;
+    pthread_cond_t readable;    // A chunk was read or the file ended
+    pthread_cond_t room;        // A member moved on or is done
+} CoalesceGroup;
+
+/* Where Packetize Data takes the chunks of a file from. */
+typedef struct FileSource
+{
+    FILE* fp;           // The file as opened for the request
+    int fd;             // Read with pread when not mapped, -1 for fread
+    const char* map;    // The whole file mapped, NULL if not mapped
+    off_t size;         // Bytes mapped
+    off_t offset;       // Next byte to send
+    UringReader* uring; // Reads in flight ahead of the sends, -u
+} FileSource;
 
 /*
 ===============================================================================
@@ -72,16 +327,22 @@ REVISIONS:      January 30, 2016    (Tyler Trepanier-Bracken)
                 Febuary 30, 2016     (Tyler Trepanier-Bracken)
                     Create the functionality to split the server and client
                     components via command-line arguments.
+                October 17, 2026        (agent)
+                    Parses the Server options before starting.
 
 DESIGNER:       Tyler Trepanier-Bracken
 
 PROGRAMMER(S):  Tyler Trepanier-Bracken
 
-INTERFACE:      int main(void)
+INTERFACE:      int main(int argc, char** argv)
 
-PARAMETERS:     void
+PARAMETERS:     int argc 
+                    The number of arguments received from command-line.
+                char** argv
+                    The arguments received from the command-line to be parsed.
 
-RETURNS:        Returns 0 on normal program termination.
+RETURNS:        -Returns 1 on improper Server options.
+                -Returns 0 on normal program termination.
 
 NOTES:
 Main entry point into the program. Simply sets the sig_actions structure to
@@ -89,7 +350,7 @@ catch any sig_int and uses the sig_handler function to deal with any issues.
 Afterwards, the Server function is called to run the program.
 ===============================================================================
 */
-int main(void);
+int main(int argc, char** argv);
 
 /*
 ===============================================================================
@@ -100,6 +361,11 @@ DATE:           January 28, 2016
 REVISIONS:      Febuary 1, 2016 (Tyler Trepanier)
                     Removed deprecated message queue tests and debug 
                     statements.
+                October 17, 2026        (agent)
+                    Opens the POSIX request queue instead of the SysV
+                    message queue when the POSIX backend is selected.
+                October 17, 2026        (agent)
+                    Creates the statistics and starts their dump (-j).
 
 DESIGNER:       Tyler Trepanier-Bracken
 
@@ -123,6 +389,202 @@ Upon user request, the message queue will terminate.
 */
 int Server(void);
 
+/*
+===============================================================================
+FUNCTION:       Read Server Arguments
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int ReadServerArguments(int argc, char** argv)
+
+PARAMETERS:     int argc 
+                    The number of arguments received from command-line.
+                char** argv
+                    The arguments received from the command-line to be parsed.
+
+RETURNS:        -Returns -1 on a improper argument formatting.
+                -Returns 0 on success.
+
+NOTES:
+Parses the Server options:
+    -P          Use the POSIX message queues instead of the SysV queue.
+    -n maxmsg   Capacity of the POSIX request queue.
+    -w workers  Serve requests from a pool of pre-forked workers.
+    -c limit    Most children forked per request running at once.
+    -t threads  Serve requests from a work-stealing thread pool.
+    -s          Send full chunks, shared out by priority with deficit
+                round robin.
+    -a          Double the chunks of a transfer each time its reply queue
+                is found drained, up to messageData.
+    -m mbytes   Keep up to mbytes of the files most recently sent in memory.
+    -M          Copy the chunks straight from a memory mapping of the file.
+===============================================================================
+*/
+int ReadServerArguments(int argc, char** argv);
+
+/*
+===============================================================================
+FUNCTION:       Server Help
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void ServerHelp(void)
+
+PARAMETERS:     void
+
+NOTES:
+Displays a help message to standard output that displays how to use this
+Server application.
+===============================================================================
+*/
+void ServerHelp(void);
+
+/*
+===============================================================================
+FUNCTION:       Read Request
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int ReadRequest(int queue, Mesg* msg)
+
+PARAMETERS:     int queue
+                    The SysV message queue or the POSIX request queue.
+                Mesg* msg
+                    Destination of the Client's request.
+
+RETURNS:        -Returns -1 on failure to read a request.
+                -Returns 0 on success.
+
+NOTES:
+Reads the next Client request from whichever backend is in use. Requests on
+the POSIX queue are received in order of the Client's priority.
+===============================================================================
+*/
+int ReadRequest(int queue, Mesg* msg);
+
+/*
+===============================================================================
+FUNCTION:       Send Reply
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int SendReply(int queue, Mesg* msg, int priority)
+
+PARAMETERS:     int queue
+                    The SysV message queue or the Client's POSIX reply queue.
+                Mesg* msg
+                    Message to send, the mesg_type must be the Client's PID.
+                int priority
+                    The Client's priority, mapped onto a POSIX priority.
+
+RETURNS:        -Returns -1 on failure to send the message.
+                -Returns 0 on success.
+
+NOTES:
+Sends a message to a Client on whichever backend is in use. A SysV send is
+first tried without waiting, only the time waited on a full queue afterwards
+counts as blocked. A POSIX send is timed as a whole.
+===============================================================================
+*/
+int SendReply(int queue, Mesg* msg, int priority);
+
+/*
+===============================================================================
+FUNCTION:       Read Request No Wait
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int ReadRequestNoWait(int queue, Mesg* msg)
+
+PARAMETERS:     int queue
+                    The SysV message queue or the POSIX request queue.
+                Mesg* msg
+                    Destination of the Client's request.
+
+RETURNS:        -Returns -1 when there is no request waiting.
+                -Returns 0 on success.
+
+NOTES:
+Same as Read Request but never blocks.
+===============================================================================
+*/
+int ReadRequestNoWait(int queue, Mesg* msg);
+
+/*
+===============================================================================
+FUNCTION:       Send Reply No Wait
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int SendReplyNoWait(int queue, Mesg* msg, int priority)
+
+PARAMETERS:     int queue
+                    The SysV message queue or the Client's POSIX reply queue,
+                    which must have been opened with O_NONBLOCK.
+                Mesg* msg
+                    Message to send, the mesg_type must be the Client's PID.
+                int priority
+                    The Client's priority, mapped onto a POSIX priority.
+
+RETURNS:        -Returns -1 on failure, errno is EAGAIN when the queue is
+                full.
+                -Returns 0 on success.
+
+NOTES:
+Same as Send Reply but never blocks. Only the messages sent are counted.
+===============================================================================
+*/
+int SendReplyNoWait(int queue, Mesg* msg, int priority);
+
+/*
+===============================================================================
+FUNCTION:       Reply Backlog
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int ReplyBacklog(int queue)
+
+PARAMETERS:     int queue
+                    The SysV message queue or the Client's POSIX reply queue.
+
+RETURNS:        -Returns -1 if the queue cannot be read.
+                -Returns the number of messages waiting on the queue.
+
+NOTES:
+A message handed to a Client which is already waiting never sits on the
+queue, so a drained queue means the Client keeps up with the Server.
+===============================================================================
+*/
+int ReplyBacklog(int queue);
+
 /*
 ===============================================================================
 FUNCTION:       Process Client 
@@ -134,6 +596,30 @@ REVISIONS:      Feb 1, 2016 (Tyler Trepanier-Bracken)
                     sending for a specific file is finished. Previously,
                     there was no final message and client was stuck reading
                     forever.
+                October 17, 2026        (agent)
+                    Opens the Client's reply queue on the POSIX backend,
+                    closing it once the Client has been served.
+                October 17, 2026        (agent)
+                    Hands the transfer to Stream To Ring when the Client
+                    sent a shared memory ring.
+                October 17, 2026        (agent)
+                    Hands the transfer to Deliver Descriptor when the Client
+                    asked for the open file.
+                October 17, 2026        (agent)
+                    Replies on the Client's own SysV queue when it sent one.
+                October 17, 2026        (agent)
+                    Sends from the content cache when the file is in it.
+                October 17, 2026        (agent)
+                    Hands batch requests to Process Batch.
+                October 17, 2026        (agent)
+                    The replies carry the mesg_id of the request, an error
+                    reply included.
+                October 17, 2026        (agent)
+                    Hands compressed requests to Packetize Compressed.
+                October 17, 2026        (agent)
+                    Keeps the flow control the Client asked for.
+                October 17, 2026        (agent)
+                    Traces the transfer when the Server was started with -T.
 
 DESIGNER:       Tyler Trepanier-Bracken
 
@@ -160,13 +646,61 @@ the Packetize Data function.
 */
 int ProcessClient(Mesg* msg, int queue);
 
+/*
+===============================================================================
+FUNCTION:       Open Cached File
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      FILE* OpenCachedFile(const char* name, CacheEntry** entry)
+
+PARAMETERS:     const char* name
+                    Path of the file requested by a Client.
+                CacheEntry** entry
+                    Set to the pinned cache entry the stream reads from, or
+                    to NULL when the stream reads the file itself.
+
+RETURNS:        -Returns the null pointer if the file could not be opened.
+                -Returns a stream of the file's contents otherwise.
+
+NOTES:
+Same as Open File but, when the Server has a cache, the stream reads the
+cached contents from memory. The entry must be given back with Cache Close
+once the stream has been closed.
+===============================================================================
+*/
+FILE* OpenCachedFile(const char* name, CacheEntry** entry);
+
 /*
 ===============================================================================
 FUNCTION:       PacketizeData 
 
 DATE:           January 9, 2016
 
-REVISIONS:      (Date and Description)
+REVISIONS:      October 17, 2026        (agent)
+                    Reads the file directly into the message and uses the
+                    number of bytes read as the mesg_len so binary files
+                    are sent intact. Sends through Send Reply so either
+                    message queue backend may be used.
+                October 17, 2026        (agent)
+                    The chunks are a share of messageData rather than of
+                    MAXMESSAGEDATA and double while the reply queue stays
+                    drained when the Server runs with -a.
+                October 17, 2026        (agent)
+                    Takes the chunks through Read Chunk so they may come
+                    from a memory mapping of the file (-M).
+                October 17, 2026        (agent)
+                    The chunks are sent by Send Contents.
+                October 17, 2026        (agent)
+                    Tags the replies with the request's mesg_id.
+                October 17, 2026        (agent)
+                    Sends the chunks within the Client's credit.
+                October 17, 2026        (agent)
+                    Traces the chunks.
 
 DESIGNER:       Tyler Trepanier-Bracken
 
@@ -176,7 +710,10 @@ PROGRAMMER(S):  Tyler Trepanier-Bracken
 INTERFACE:      int PacketizeData(FILE* fp,
                   const int queue,
                   const long msg_type,
-                  const int priority);
+                  const long request,
+                  const int priority,
+                  Credit* credit,
+                  Trace* trace);
 
 PARAMETERS:     FILE* fp,
                     File pointer to a previously opened file for reading.
@@ -186,9 +723,15 @@ PARAMETERS:     FILE* fp,
                 const long msg_type,
                     The message type of the client who will receive the
                     series of messages.
+                const long request,
+                    The mesg_id of the request, copied into every reply.
                 const int priority);
                     How urgent the clients wishes to receive the data. It is
                     a number in between 1-1000.                    
+                Credit* credit
+                    The transfer's flow control, NULL for none.
+                Trace* trace
+                    The transfer's latency trace, NULL for none.
 
 RETURNS:        -Returns the PID of process specified if the process
                 exists.          
@@ -207,74 +750,1008 @@ message indicating that the reading is finished.
 int PacketizeData(FILE* fp,
                   const int queue,
                   const long msg_type,
-                  const int priority);
+                  const long request,
+                  const int priority,
+                  Credit* credit,
+                  Trace* trace);
 
 /*
 ===============================================================================
-FUNCTION:       Designate Priority 
+FUNCTION:       Send Contents
 
-DATE:           January 9, 2016
+DATE:           October 17, 2026
 
-REVISIONS:      (Date and Description)
+DESIGNER:       agent
 
-DESIGNER:       Tyler Trepanier-Bracken
+PROGRAMMER(S):  agent
 
-PROGRAMMER(S):  Tyler Trepanier-Bracken
-                Harvey Dent
+INTERFACE:      int SendContents(FILE* fp, Mesg* snd, int queue,
+                      int priority, off_t limit, Credit* credit,
+                      Trace* trace)
 
-INTERFACE:      int DesignatePriority(const char* text,
-                      char* name,
-                      int* priority,
-                      pid_t* client)
+PARAMETERS:     FILE* fp
+                    The file to send, left open.
+                Mesg* snd
+                    The message the chunks are sent in, its type already set
+                    to the Client.
+                int queue
+                    The queue the replies are sent on.
+                int priority
+                    The Client's priority, which sizes the chunks.
+                off_t limit
+                    Exactly how many bytes to send, -1 for the whole file.
+                Credit* credit
+                    The transfer's flow control, NULL for none.
+                Trace* trace
+                    The transfer's latency trace, NULL for none. The chunks
+                    are numbered on from snd->mesg_seq.
+
+RETURNS:        -Returns -1 if a reply could not be sent.
+                -Returns 0 otherwise.
 
-PARAMETERS:     const char* text,
-                    File pointer to a previously opened file for reading.
-                char* name,
-                    The message queue on which the server will write
-                    messages to. This is the filename which is the first
-                    part of the message that is parsed.
-                int priority);
-                    How urgent the clients wishes to receive the data. This
-                    field is filled using the text's data.
-                pid_t* long client,
-                    The message type of the client who will receive the
-                    series of messages. This field is filled using the text's 
-                    data.
+NOTES:
+Sends the chunks of a file without the final message. With a limit the
+Client counts on exactly limit bytes, so a file which shrinks underneath the
+transfer is padded with zeros and one which grows is cut short.
 
-RETURNS:        -Returns the PID of process specified if the process
-                exists.          
-                -Returns 0 if the process was not found in the process table.
+With -R a file with a descriptor is read by a Read Ahead thread and the
+chunks it has filled are sent as they are. Cached files are already in
+memory and are read by the sender itself.
+===============================================================================
+*/
+int SendContents(FILE* fp, Mesg* snd, int queue, int priority, off_t limit,
+                 Credit* credit, Trace* trace);
+
+/*
+===============================================================================
+FUNCTION:       Chunk Size
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      size_t ChunkSize(int priority)
+
+PARAMETERS:     int priority
+                    The Client's priority, 1 to 1000.
+
+RETURNS:        The bytes sent in each message, messageData / priority.
+===============================================================================
+*/
+size_t ChunkSize(int priority);
+
+/*
+===============================================================================
+FUNCTION:       Packetize Compressed
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int PacketizeCompressed(FILE* fp,
+                      const int queue,
+                      const long msg_type,
+                      const long request,
+                      const int priority,
+                      Credit* credit)
+
+PARAMETERS:     Same as Packetize Data.
+
+RETURNS:        -Returns -1 if the answer could not be sent.
+                -Returns 0 otherwise.
 
 NOTES:
-Simple wrapper function that parses the text received by the client and
-extracts the name of the file, the designated priority and the client's PID
-(which will become the message type).
+Answers a zip=1 request, then sends the file as one zlib stream. Up to
+ZIP_READ_SCALE chunks of the file are read at a time and every message but
+the last is filled with exactly one chunk of compressed bytes, so a text
+file takes a fraction of the messages and of the queue's bytes. The stream
+is only flushed at the end of the file.
+
+A Server built without USE_ZLIB, or which cannot start the stream, answers
+zip=0 and falls back to Packetize Data.
 ===============================================================================
 */
-int DesignatePriority(const char* text,
-                      char* name,
-                      int* priority,
-                      pid_t* client);
+int PacketizeCompressed(FILE* fp,
+                        const int queue,
+                        const long msg_type,
+                        const long request,
+                        const int priority,
+                        Credit* credit);
 
 /*
 ===============================================================================
-FUNCTION:       Search For Clients 
+FUNCTION:       Answer Compression
 
-DATE:           January 30, 2016            
+DATE:           October 17, 2026
 
-DESIGNER:       Tyler Trepanier-Bracken
+DESIGNER:       agent
 
-PROGRAMMER(S):  Tyler Trepanier-Bracken
+PROGRAMMER(S):  agent
 
-INTERFACE:      int SearchForClients(void)
+INTERFACE:      int AnswerCompression(int queue, long msg_type,
+                      long request, int priority, int accepted)
 
-PARAMETERS:     void
+PARAMETERS:     int queue
+                    The queue the replies are sent on.
+                long msg_type
+                    The Client's process id.
+                long request
+                    The mesg_id of the request.
+                int priority
+                    The Client's priority.
+                int accepted
+                    1 when the file follows compressed, 0 when it does not.
 
-RETURNS:        -Returns 1 on improper termination.
-                -Returns 0 when the user gracefully terminates the reading.
+RETURNS:        -Returns -1 if the answer could not be sent.
+                -Returns 0 otherwise.
 
 NOTES:
-Searches for multiple clients and assigns each client a separate process.
+The answer is the first reply to a zip=1 request, its data being exactly
+"zip=1" or "zip=0".
 ===============================================================================
 */
-int SearchForClients(void);
+int AnswerCompression(int queue, long msg_type, long request, int priority,
+                      int accepted);
+
+/*
+===============================================================================
+FUNCTION:       Open Credit
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int OpenCredit(Credit* credit, int queue, pid_t client,
+                      long window)
+
+PARAMETERS:     Credit* credit
+                    Set up for the transfer.
+                int queue
+                    The reply queue, the grants arrive on it too.
+                pid_t client
+                    The Client's process id.
+                long window
+                    Chunks the Client allows in flight, 0 for no limit.
+
+RETURNS:        -Returns -1 when out of memory.
+                -Returns 0 otherwise.
+
+NOTES:
+Flow control is only kept on the SysV backend, a POSIX reply queue is read
+only by its Client and cannot carry the grants back.
+===============================================================================
+*/
+int OpenCredit(Credit* credit, int queue, pid_t client, long window);
+
+/*
+===============================================================================
+FUNCTION:       Take Credit
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int TakeCredit(Credit* credit)
+
+PARAMETERS:     Credit* credit
+                    The transfer's credit, NULL for no limit.
+
+RETURNS:        -Returns -1 if the Server quit or the queue went away while
+                    waiting.
+                -Returns 0 once a chunk may be sent.
+
+NOTES:
+Uses up one chunk of credit, first waiting for a grant from the Client when
+there is none left. So no Client ever has more than its window of chunks
+waiting on the queue however fast the Server reads the file, and a slow
+Client cannot fill msg_qbytes for everybody else.
+
+A Client which dies without removing its queue leaves the sender waiting
+for a grant, as it would leave it waiting on a full queue before.
+===============================================================================
+*/
+int TakeCredit(Credit* credit);
+
+/*
+===============================================================================
+FUNCTION:       Send With Credit
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int SendWithCredit(int queue, Mesg* msg, int priority,
+                      Credit* credit)
+
+PARAMETERS:     int queue
+                    The reply queue.
+                Mesg* msg
+                    A chunk of the file.
+                int priority
+                    The Client's priority.
+                Credit* credit
+                    The transfer's credit, NULL for no limit.
+
+RETURNS:        -Returns -1 if there was no credit or the send failed.
+                -Returns 0 otherwise.
+
+NOTES:
+Send Reply after Take Credit. Only the chunks of a file are counted, the
+answers, batch headers and final messages are always sent.
+===============================================================================
+*/
+int SendWithCredit(int queue, Mesg* msg, int priority, Credit* credit);
+
+/*
+===============================================================================
+FUNCTION:       Close Credit
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void CloseCredit(Credit* credit)
+
+PARAMETERS:     Credit* credit
+                    A credit set up by Open Credit, even if it failed.
+
+RETURNS:        void
+
+NOTES:
+Takes any grant still waiting for this transfer off of the queue. The Client
+takes off the grants that arrive later itself, once it has the final
+message.
+===============================================================================
+*/
+void CloseCredit(Credit* credit);
+
+/*
+===============================================================================
+FUNCTION:       Process Batch
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int ProcessBatch(const char* pattern, int queue,
+                      pid_t client, long request, int priority,
+                      Credit* credit, Trace* trace)
+
+PARAMETERS:     const char* pattern
+                    A glob pattern, or a directory standing for every file
+                    directly inside of it.
+                int queue
+                    The queue the replies are sent on.
+                pid_t client
+                    The Client's process id, the type of every reply.
+                long request
+                    The mesg_id of the request, copied into every reply.
+                int priority
+                    The Client's priority.
+                Credit* credit
+                    The transfer's flow control, NULL for none.
+                Trace* trace
+                    The batch's latency trace, NULL for none.
+
+RETURNS:        -Returns -1 if a reply could not be sent.
+                -Returns 0 otherwise.
+
+NOTES:
+Serves every matching file in one go so a Client after many small files
+costs one request, one worker and one final message. Each file is sent as a
+header message "size path" followed by exactly size bytes of contents; a
+file that cannot be opened has a size of -1 and no contents. Directories
+among the matches are skipped. The final message ends the whole batch.
+===============================================================================
+*/
+int ProcessBatch(const char* pattern, int queue, pid_t client, long request,
+                 int priority, Credit* credit, Trace* trace);
+
+/*
+===============================================================================
+FUNCTION:       Open Source
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void OpenSource(FileSource* src, FILE* fp)
+
+PARAMETERS:     FileSource* src
+                    Filled in with where the chunks come from.
+                FILE* fp
+                    The file opened for the request.
+
+RETURNS:        void
+
+NOTES:
+Without -M the chunks are read with fread as before. With -M a regular file
+is mapped whole and advised as sequential. When the mapping fails the file is
+read with pread instead, and cached files, which have no descriptor, keep
+using fread.
+
+With -u (and without -M) a regular file is read through an io_uring reader
+which keeps several reads in flight ahead of the sends. Where io_uring cannot
+be used the file is read with pread.
+
+A file truncated by someone else while it is being sent from a mapping
+raises SIGBUS in the Server, the same as any other mapped file reader.
+===============================================================================
+*/
+void OpenSource(FileSource* src, FILE* fp);
+
+/*
+===============================================================================
+FUNCTION:       Read Chunk
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      size_t ReadChunk(FileSource* src, char* where, size_t size)
+
+PARAMETERS:     FileSource* src
+                    A source set up by Open Source.
+                char* where
+                    The message data the chunk is copied into.
+                size_t size
+                    Most bytes to copy.
+
+RETURNS:        The number of bytes copied, 0 at the end of the file.
+
+NOTES:
+A read ahead that fails is given up and the file is read with pread from
+the next byte to send on. So is a mapping whose file was truncated: the copy
+faults with SIGBUS, bus_handler jumps back here and pread then finds the new
+end of the file, which ends only this transfer.
+===============================================================================
+*/
+size_t ReadChunk(FileSource* src, char* where, size_t size);
+
+/*
+===============================================================================
+FUNCTION:       Close Source
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void CloseSource(FileSource* src)
+
+PARAMETERS:     FileSource* src
+                    A source set up by Open Source.
+
+RETURNS:        void
+
+NOTES:
+Unmaps the file or stops its reads ahead, the FILE itself is still closed by
+the caller.
+===============================================================================
+*/
+void CloseSource(FileSource* src);
+
+/*
+===============================================================================
+FUNCTION:       Designate Priority 
+
+DATE:           January 9, 2016
+
+REVISIONS:      (Date and Description)
+
+DESIGNER:       Tyler Trepanier-Bracken
+
+PROGRAMMER(S):  Tyler Trepanier-Bracken
+                Harvey Dent
+
+INTERFACE:      int DesignatePriority(const char* text,
+                      char* name,
+                      int* priority,
+                      pid_t* client)
+
+PARAMETERS:     const char* text,
+                    File pointer to a previously opened file for reading.
+                char* name,
+                    The message queue on which the server will write
+                    messages to. This is the filename which is the first
+                    part of the message that is parsed.
+                int priority);
+                    How urgent the clients wishes to receive the data. This
+                    field is filled using the text's data.
+                pid_t* long client,
+                    The message type of the client who will receive the
+                    series of messages. This field is filled using the text's 
+                    data.
+
+RETURNS:        -Returns the PID of process specified if the process
+                exists.          
+                -Returns 0 if the process was not found in the process table.
+
+NOTES:
+Simple wrapper function that parses the text received by the client and
+extracts the name of the file, the designated priority and the client's PID
+(which will become the message type).
+===============================================================================
+*/
+int DesignatePriority(const char* text,
+                      char* name,
+                      int* priority,
+                      pid_t* client);
+
+/*
+===============================================================================
+FUNCTION:       Read Request Options
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int ReadRequestOptions(const char* text,
+                      RequestOptions* opts)
+
+PARAMETERS:     const char* text
+                    The request text received from the Client.
+                RequestOptions* opts
+                    Filled in with the options of the request, any option
+                    that is not present keeps its default.
+
+RETURNS:        -Returns -1 if the request has no "name priority pid".
+                -Returns 0 on success.
+
+NOTES:
+Parses the key=value options that follow the part of the request read by
+Designate Priority. Unknown options are ignored so older Servers still serve
+newer Clients.
+    ring=<shmid>    Stream the file through the Client's shared memory ring.
+    fd=1            Pass the open file to the Client over its Unix socket.
+    queue=<msqid>   Send the replies on the Client's own SysV queue.
+    batch=1         Send every file matching the name, see Process Batch.
+    zip=1           Compress the file, see Packetize Compressed.
+    credit=<n>      Never have more than n chunks on the queue, see Take
+                    Credit.
+    stats=1         Send the Server's statistics instead, see Send Stats.
+===============================================================================
+*/
+int ReadRequestOptions(const char* text, RequestOptions* opts);
+
+/*
+===============================================================================
+FUNCTION:       Plain Request
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int PlainRequest(const RequestOptions* opts)
+
+PARAMETERS:     const RequestOptions* opts
+                    The options of the request.
+
+RETURNS:        -Returns 1 if the request is for one file sent in chunks on
+                 a queue.
+                -Returns 0 otherwise.
+
+NOTES:
+Only plain requests are taken over by the scheduler, the event loop and
+Dispatch Coalesced, the rest are always given a forked child. A new option
+which changes how a file is sent belongs here.
+===============================================================================
+*/
+int PlainRequest(const RequestOptions* opts);
+
+/*
+===============================================================================
+FUNCTION:       Stream To Ring
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int StreamToRing(const char* name, pid_t client, int shmid)
+
+PARAMETERS:     const char* name
+                    Name of the file requested by the Client.
+                pid_t client
+                    PID of the Client.
+                int shmid
+                    Shared memory id of the Client's ring.
+
+RETURNS:        -Returns -1 if the ring could not be attached.
+                -Returns 0 once the ring has been closed.
+
+NOTES:
+Bulk transfer path which keeps the file off of the message queue. The file is
+read with read(2) directly into the free space of the ring so the only copies
+are the kernel's copy into the ring and the Client's write out of it. The
+ring is closed in place of the final message. The priority does not throttle
+ring transfers.
+===============================================================================
+*/
+int StreamToRing(const char* name, pid_t client, int shmid);
+
+/*
+===============================================================================
+FUNCTION:       Deliver Descriptor
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int DeliverDescriptor(const char* name, pid_t client)
+
+PARAMETERS:     const char* name
+                    Name of the file requested by the Client.
+                pid_t client
+                    PID of the Client.
+
+RETURNS:        -Returns -1 if the Client's socket could not be reached.
+                -Returns 0 on success.
+
+NOTES:
+Zero-copy path for plain file requests. Opening the file with the Server's
+permissions is the access check; the open descriptor is then passed to the
+Client with SCM_RIGHTS and the Client copies the file to its own output.
+Only regular files are passed, anything else is answered with the same
+error text as a file that cannot be opened.
+===============================================================================
+*/
+int DeliverDescriptor(const char* name, pid_t client);
+
+/*
+===============================================================================
+FUNCTION:       Search For Clients 
+
+DATE:           January 30, 2016            
+
+DESIGNER:       Tyler Trepanier-Bracken
+
+PROGRAMMER(S):  Tyler Trepanier-Bracken
+
+INTERFACE:      int SearchForClients(void)
+
+PARAMETERS:     void
+
+RETURNS:        -Returns 1 on improper termination.
+                -Returns 0 when the user gracefully terminates the reading.
+
+NOTES:
+Searches for multiple clients and assigns each client a separate process.
+When a worker pool or a thread pool is configured the requests are left to
+the pool instead, likewise to the scheduler or the event loop when it is
+selected. With -g the requests are handed to Dispatch Coalesced.
+===============================================================================
+*/
+int SearchForClients(void);
+
+/*
+===============================================================================
+FUNCTION:       Dispatch Coalesced
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int DispatchCoalesced(Mesg* first)
+
+PARAMETERS:     Mesg* first
+                    The request just read, left untouched.
+
+RETURNS:        -Returns -1 when out of memory.
+                -Returns 0 otherwise.
+
+NOTES:
+Takes every other request already waiting on the queue, up to COALESCE_MAX,
+and groups those asking for the same version of the same file at the same
+priority. A group for a file whose read is still going joins it with Join
+Coalesced Read. Any other group starts a read of its own: one forked child
+with Serve Coalesced, kept in the table of reads until it is reaped so the
+requests which come after may join it. A request which cannot be shared is
+served by a child running Process Client as before, and so is a lone one
+once the table is full.
+
+A request never waits for others to join it, the read goes ahead at once
+and those arriving later are sent what it already read.
+===============================================================================
+*/
+int DispatchCoalesced(Mesg* first);
+
+/*
+===============================================================================
+FUNCTION:       Join Coalesced Read
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int JoinCoalescedRead(const CoalesceKey* key,
+                      Mesg** group, int count)
+
+PARAMETERS:     const CoalesceKey* key
+                    The file and priority of the requests.
+                Mesg** group
+                    Requests with that key.
+                int count
+                    How many there are.
+
+RETURNS:        -Returns how many of the first requests were joined, 0 when
+                 no read of the file is going.
+
+NOTES:
+Passes the requests to the child reading the file over its join socket,
+without blocking. Those the socket has no room for are left to the caller.
+===============================================================================
+*/
+int JoinCoalescedRead(const CoalesceKey* key, Mesg** group, int count);
+
+/*
+===============================================================================
+FUNCTION:       End Coalesced Read
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int EndCoalescedRead(pid_t child)
+
+PARAMETERS:     pid_t child
+                    A child just reaped.
+
+RETURNS:        -Returns how many requests were left on the join socket.
+
+NOTES:
+Frees the read of the child from the table. A request joined after the child
+stopped taking them is served by a child of its own running Process Client.
+===============================================================================
+*/
+int EndCoalescedRead(pid_t child);
+
+/*
+===============================================================================
+FUNCTION:       Read Coalesce Key
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int ReadCoalesceKey(Mesg* msg, CoalesceKey* key)
+
+PARAMETERS:     Mesg* msg
+                    A request.
+                CoalesceKey* key
+                    Filled with the file and priority of the request.
+
+RETURNS:        -Returns -1 if the request must be served on its own.
+                -Returns 0 if it may share its transfer.
+
+NOTES:
+The file is told apart by its device, inode, size and modification time, so
+two names of one file are grouped and a file rewritten in between is not.
+Only plain requests are grouped: a ring, descriptor, batch, compressed,
+credited or stats request is served on its own, and so is every request
+while the Server traces (-T).
+===============================================================================
+*/
+int ReadCoalesceKey(Mesg* msg, CoalesceKey* key);
+
+/*
+===============================================================================
+FUNCTION:       Serve Coalesced
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int ServeCoalesced(Mesg** requests, int count,
+                      const int* join)
+
+PARAMETERS:     Mesg** requests
+                    Requests with equal keys.
+                int count
+                    How many there are.
+                const int* join
+                    The join socket of the read, NULL when none may join.
+
+RETURNS:        -Returns -1 if nobody could be sent the file.
+                -Returns 0 otherwise.
+
+NOTES:
+Reads each chunk once into a ring of the last COALESCE_LAG chunks, while
+every Client of the group is sent them by a thread of its own (Add Member),
+each under its own message type and mesg_id, so every Client sees exactly
+the replies it would have been sent alone. Requests the Server joins to the
+read later are taken from the join socket by another thread and added the
+same way. The reader sleeps until the slowest member has room in the ring,
+and the members until the reader has a chunk for them.
+
+A member which joined late, or which fell COALESCE_LAG chunks behind the
+fastest member the reader waits for, is sent what left the ring from the file
+itself, then goes on from the ring. A member with its own queue is let fall
+behind so a stalled Client never holds up the others. On the shared SysV
+queue a full queue is full for everyone, there the group goes at the rate of
+its slowest member.
+
+Once nobody is left the join socket is closed with an empty message, whoever
+joined before it is still sent the file.
+===============================================================================
+*/
+int ServeCoalesced(Mesg** requests, int count, const int* join);
+
+/*
+===============================================================================
+FUNCTION:       Add Member
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int AddMember(CoalesceGroup* group, Mesg* request)
+
+PARAMETERS:     CoalesceGroup* group
+                    The read being shared.
+                Mesg* request
+                    A request for its file.
+
+RETURNS:        -Returns -1 if the member could not be started, the request
+                 is then the caller's to serve.
+                -Returns 0 on success.
+
+NOTES:
+Starts the thread sending the Client the file, from the first chunk. Its
+sends block, a full queue only holds back the member itself.
+===============================================================================
+*/
+int AddMember(CoalesceGroup* group, Mesg* request);
+
+/*
+===============================================================================
+FUNCTION:       Reap Children
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void ReapChildren(int block)
+
+PARAMETERS:     int block
+                    Wait for at least one child to finish when non-zero.
+
+RETURNS:        void
+
+NOTES:
+Collects every finished child of Search For Clients so they do not remain as
+zombies, and keeps count of the children still running for the -c limit.
+With -g the read of a reaped child is ended with End Coalesced Read.
+Only the children in the Server's process group are collected, where every
+child forked for a request stays. The statistics dump moves to a group of
+its own so it is neither reaped nor counted here.
+===============================================================================
+*/
+void ReapChildren(int block);
+
+/*
+===============================================================================
+FUNCTION:       Run Worker Pool
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int RunWorkerPool(void)
+
+PARAMETERS:     void
+
+RETURNS:        Returns 0 once every worker has stopped.
+
+NOTES:
+Forks the configured number of workers up front, which saves a fork for
+every request and bounds the number of transfers running at once. The parent
+only supervises: a worker that stops before the Server quits has crashed and
+is replaced. On quit, every worker is told to stop and is reaped.
+===============================================================================
+*/
+int RunWorkerPool(void);
+
+/*
+===============================================================================
+FUNCTION:       Spawn Worker
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      pid_t SpawnWorker(void)
+
+PARAMETERS:     void
+
+RETURNS:        -Returns -1 if the worker could not be forked.
+                -Returns the PID of the worker to the parent.
+
+NOTES:
+The worker never returns: it reads requests from the queue and serves them
+with Process Client one at a time until the Server quits.
+===============================================================================
+*/
+pid_t SpawnWorker(void);
+
+/*
+===============================================================================
+FUNCTION:       Send Stats
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int SendStats(int queue, long msg_type, long request,
+                      int priority)
+
+PARAMETERS:     int queue
+                    The Client's reply queue.
+                long msg_type
+                    The Client's PID.
+                long request
+                    The mesg_id of the request.
+                int priority
+                    The Client's priority.
+
+RETURNS:        -Returns -1 if a reply could not be sent.
+                -Returns 0 otherwise.
+
+NOTES:
+Answers a stats=1 request with one line of JSON followed by the final
+message, so any Client prints it like a small file. The rates are averages
+since the Server started.
+===============================================================================
+*/
+int SendStats(int queue, long msg_type, long request, int priority);
+
+/*
+===============================================================================
+FUNCTION:       Spawn Stats Dumper
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      pid_t SpawnStatsDumper(const char* path)
+
+PARAMETERS:     const char* path
+                    File the statistics are appended to, "-" for stdout.
+
+RETURNS:        -Returns -1 if the dumper could not be forked.
+                -Returns the PID of the dumper to the parent.
+
+NOTES:
+The dumper appends one line of JSON every STATS_INTERVAL seconds until the
+Server quits, the rates of each line being measured since the one before.
+It is a process rather than a thread so the Server may keep forking safely.
+It runs in a process group of its own, so it no longer sees the terminal's
+^C. It stops when the Server tells it to, or once the Server is gone.
+===============================================================================
+*/
+pid_t SpawnStatsDumper(const char* path);
+
+/*
+===============================================================================
+FUNCTION:       Run Thread Pool
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int RunThreadPool(void)
+
+PARAMETERS:     void
+
+RETURNS:        -Returns 1 if the thread pool could not be started.
+                -Returns 0 once every worker thread has stopped.
+
+NOTES:
+Thread based alternative to forking. This thread becomes the dispatcher: it
+reads every request and submits it to the work-stealing pool, whose worker
+threads run Process Client. No process is forked per request and the
+workers share the Server's memory. On quit the requests already queued are
+still answered before the pool stops.
+===============================================================================
+*/
+int RunThreadPool(void);
+
+/*
+===============================================================================
+FUNCTION:       child_handler
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void child_handler(int sig)
+
+PARAMETERS:     int sig
+                    The SIGCHLD that was caught.
+
+RETURNS:        void
+
+NOTES:
+Does nothing by itself. Catching the SIGCHLD interrupts the Server's wait for
+the next request so that Search For Clients reaps the finished child right
+away instead of on the next request.
+===============================================================================
+*/
+void child_handler(int sig);
+
+/*
+===============================================================================
+FUNCTION:       bus_handler
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void bus_handler(int sig)
+
+PARAMETERS:     int sig
+                    The SIGBUS that was caught.
+
+RETURNS:        void
+
+NOTES:
+A SIGBUS raised while Read Chunk copies from a mapping jumps back into Read
+Chunk through mapFault, which is kept per thread for the thread pool and the
+read ahead. Any other SIGBUS is a real fault and kills the Server as before.
+===============================================================================
+*/
+void bus_handler(int sig);
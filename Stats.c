@@ -0,0 +1,138 @@
+/*
+===============================================================================
+SOURCE FILE:    Stats.c
+                    Definition file for the Server's live statistics.
+
+PROGRAM:        Server
+
+FUNCTIONS:      Stats* CreateStats(void)
+                void StatsRequest(Stats* stats)
+                void StatsTransfer(Stats* stats, long change)
+                void StatsSent(Stats* stats, size_t len,
+                      unsigned long blocked)
+                void TakeSnapshot(Stats* stats, StatsSnapshot* snap)
+                int FormatStats(char* out, size_t size,
+                      StatsSnapshot* now, StatsSnapshot* before, int depth)
+                unsigned long ElapsedNs(struct timespec* since)
+
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER:     agent
+
+NOTES:
+The counters are only ever added to with relaxed atomics, a reader does not
+need them to agree with each other exactly.
+===============================================================================
+*/
+
+#include "Stats.h"
+
+Stats* CreateStats(void)
+{
+    Stats* stats;
+    int shmid;
+
+    shmid = shmget(IPC_PRIVATE, sizeof(Stats), MSGPERM | IPC_CREAT);
+    if(shmid < 0)
+    {
+        return NULL;
+    }
+
+    stats = shmat(shmid, NULL, 0);
+    shmctl(shmid, IPC_RMID, NULL);
+    if(stats == (void*)-1)
+    {
+        return NULL;
+    }
+
+    memset(stats, 0, sizeof(Stats));
+    clock_gettime(CLOCK_MONOTONIC, &stats->started);
+
+    return stats;
+}
+
+void StatsRequest(Stats* stats)
+{
+    if(stats != NULL)
+        atomic_fetch_add_explicit(&stats->requests, 1, memory_order_relaxed);
+}
+
+void StatsTransfer(Stats* stats, long change)
+{
+    if(stats != NULL)
+        atomic_fetch_add_explicit(&stats->active, change,
+            memory_order_relaxed);
+}
+
+void StatsSent(Stats* stats, size_t len, unsigned long blocked)
+{
+    if(stats == NULL)
+        return;
+
+    atomic_fetch_add_explicit(&stats->chunks, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&stats->bytes, len, memory_order_relaxed);
+    if(blocked > 0)
+        atomic_fetch_add_explicit(&stats->blocked, blocked,
+            memory_order_relaxed);
+}
+
+void TakeSnapshot(Stats* stats, StatsSnapshot* snap)
+{
+    memset(snap, 0, sizeof(StatsSnapshot));
+    if(stats == NULL)
+        return;
+
+    snap->uptime = ElapsedNs(&stats->started) / 1e9;
+    snap->requests = atomic_load_explicit(&stats->requests,
+        memory_order_relaxed);
+    snap->active = atomic_load_explicit(&stats->active, memory_order_relaxed);
+    snap->chunks = atomic_load_explicit(&stats->chunks, memory_order_relaxed);
+    snap->bytes = atomic_load_explicit(&stats->bytes, memory_order_relaxed);
+    snap->blocked = atomic_load_explicit(&stats->blocked,
+        memory_order_relaxed);
+}
+
+int FormatStats(char* out, size_t size, StatsSnapshot* now,
+                StatsSnapshot* before, int depth)
+{
+    StatsSnapshot start;
+    double period;
+
+    if(before == NULL)
+    {
+        memset(&start, 0, sizeof(start));
+        before = &start;
+    }
+
+    // Never divide by a period too short to measure.
+    if((period = now->uptime - before->uptime) < 1e-3)
+        period = 1e-3;
+
+    return snprintf(out, size,
+        "{\"uptime\":%.3f,\"period\":%.3f,"
+        "\"requests\":%lu,\"requests_per_sec\":%.1f,"
+        "\"active_transfers\":%ld,"
+        "\"chunks\":%lu,\"chunks_per_sec\":%.1f,"
+        "\"bytes\":%lu,\"bytes_per_sec\":%.0f,"
+        "\"blocked_ms\":%.3f,\"blocked_share\":%.3f,"
+        "\"queue_depth\":%d}",
+        now->uptime, period,
+        now->requests, (now->requests - before->requests) / period,
+        now->active,
+        now->chunks, (now->chunks - before->chunks) / period,
+        now->bytes, (now->bytes - before->bytes) / period,
+        now->blocked / 1e6, (now->blocked - before->blocked) / 1e9 / period,
+        depth);
+}
+
+unsigned long ElapsedNs(struct timespec* since)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - since->tv_sec) * 1000000000UL +
+        now.tv_nsec - since->tv_nsec;
+}
@@ -0,0 +1,245 @@
+/*
+===============================================================================
+SOURCE FILE:    Stats.h
+                    Header file for the Server's live statistics.
+
+PROGRAM:        Server
+
+FUNCTIONS:      Stats* CreateStats(void)
+                void StatsRequest(Stats* stats)
+                void StatsTransfer(Stats* stats, long change)
+                void StatsSent(Stats* stats, size_t len,
+                      unsigned long blocked)
+                void TakeSnapshot(Stats* stats, StatsSnapshot* snap)
+                int FormatStats(char* out, size_t size,
+                      StatsSnapshot* now, StatsSnapshot* before, int depth)
+                unsigned long ElapsedNs(struct timespec* since)
+
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER:     agent
+
+NOTES:
+Counts what the Server does so that a saturated Server can be told apart
+from an idle one: the requests taken, the transfers in progress, the chunks
+and bytes sent and the time senders spent waiting on a full queue.
+
+Like the cache, the counters live in a shared memory segment created before
+any fork, so forked children, pre-forked workers and pool threads all add to
+the same counters. They are plain atomics, no lock is ever taken.
+
+The counters only grow. Rates are worked out between two snapshots, either
+since the Server started (a stats request) or since the last line of the
+periodic dump (Server -j).
+===============================================================================
+*/
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdatomic.h>
+#include <time.h>
+#include <sys/shm.h>
+#include "Utilities.h"
+
+#define STATS_INTERVAL      1       // Seconds between the lines of the dump
+
+/* Header of the shared memory segment holding the counters. */
+typedef struct
+{
+    struct timespec started;    // CLOCK_MONOTONIC when the Server started
+    atomic_ulong requests;      // Requests taken off of the queue
+    atomic_long active;         // Transfers in progress
+    atomic_ulong chunks;        // Replies sent, the final ones included
+    atomic_ulong bytes;         // Bytes of file sent
+    atomic_ulong blocked;       // Nanoseconds senders waited on a full queue
+} Stats;
+
+/* The counters at one moment. */
+typedef struct
+{
+    double uptime;              // Seconds since the Server started
+    unsigned long requests;
+    long active;
+    unsigned long chunks;
+    unsigned long bytes;
+    unsigned long blocked;
+} StatsSnapshot;
+
+/*
+===============================================================================
+FUNCTION:       Create Stats
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      Stats* CreateStats(void)
+
+PARAMETERS:     void
+
+RETURNS:        -Returns NULL on failure to create the shared memory.
+                -Returns the attached counters, all zero, on success.
+
+NOTES:
+Must be called before the Server forks. The segment is marked for removal
+right away and disappears with the last process using it.
+===============================================================================
+*/
+Stats* CreateStats(void);
+
+/*
+===============================================================================
+FUNCTION:       Stats Request
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void StatsRequest(Stats* stats)
+
+PARAMETERS:     Stats* stats
+                    The Server's counters, NULL when there are none.
+
+RETURNS:        void
+===============================================================================
+*/
+void StatsRequest(Stats* stats);
+
+/*
+===============================================================================
+FUNCTION:       Stats Transfer
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void StatsTransfer(Stats* stats, long change)
+
+PARAMETERS:     Stats* stats
+                    The Server's counters, NULL when there are none.
+                long change
+                    1 when a transfer starts, -1 when it ends.
+
+RETURNS:        void
+===============================================================================
+*/
+void StatsTransfer(Stats* stats, long change);
+
+/*
+===============================================================================
+FUNCTION:       Stats Sent
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void StatsSent(Stats* stats, size_t len,
+                      unsigned long blocked)
+
+PARAMETERS:     Stats* stats
+                    The Server's counters, NULL when there are none.
+                size_t len
+                    Bytes in the reply just sent.
+                unsigned long blocked
+                    Nanoseconds the send waited for room, 0 if it did not.
+
+RETURNS:        void
+===============================================================================
+*/
+void StatsSent(Stats* stats, size_t len, unsigned long blocked);
+
+/*
+===============================================================================
+FUNCTION:       Take Snapshot
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void TakeSnapshot(Stats* stats, StatsSnapshot* snap)
+
+PARAMETERS:     Stats* stats
+                    The Server's counters, NULL when there are none.
+                StatsSnapshot* snap
+                    Filled with the counters, all zero without any.
+
+RETURNS:        void
+
+NOTES:
+The counters are read one at a time while the Server keeps running, they
+may be a chunk or two apart from one another.
+===============================================================================
+*/
+void TakeSnapshot(Stats* stats, StatsSnapshot* snap);
+
+/*
+===============================================================================
+FUNCTION:       Format Stats
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int FormatStats(char* out, size_t size,
+                      StatsSnapshot* now, StatsSnapshot* before, int depth)
+
+PARAMETERS:     char* out
+                    Receives one line of JSON, without a newline.
+                size_t size
+                    Room in out.
+                StatsSnapshot* now
+                    The counters to report.
+                StatsSnapshot* before
+                    An earlier snapshot the rates are measured from, NULL
+                    for the rates since the Server started.
+                int depth
+                    Messages waiting on the Server's queue, -1 if unknown.
+
+RETURNS:        The length of the line, as snprintf.
+
+NOTES:
+blocked_share is the part of the period senders spent waiting on a full
+queue, summed over every sender. Above 1 means several of them were waiting
+at once, a sure sign the Clients cannot keep up.
+===============================================================================
+*/
+int FormatStats(char* out, size_t size, StatsSnapshot* now,
+                StatsSnapshot* before, int depth);
+
+/*
+===============================================================================
+FUNCTION:       Elapsed Ns
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      unsigned long ElapsedNs(struct timespec* since)
+
+PARAMETERS:     struct timespec* since
+                    A CLOCK_MONOTONIC time.
+
+RETURNS:        The nanoseconds since then.
+===============================================================================
+*/
+unsigned long ElapsedNs(struct timespec* since);
+
+#endif
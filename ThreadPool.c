@@ -0,0 +1,225 @@
+/*
+===============================================================================
+SOURCE FILE:    ThreadPool.c
+                    Definition file for the Server's work-stealing thread
+                    pool.
+
+PROGRAM:        Server
+
+FUNCTIONS:      ThreadPool* CreateThreadPool(int threads, int queue,
+                                             Task task)
+                int SubmitTask(ThreadPool* pool, Mesg* msg)
+                void DestroyThreadPool(ThreadPool* pool)
+                static Mesg* TakeTask(ThreadPool* pool, int index)
+                static void* RunWorker(void* arg)
+
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER:     agent
+
+NOTES:
+Each deque has its own lock so the dispatcher, the owner and a thief only
+ever contend on one deque at a time. The pool lock only guards the count of
+waiting requests which the idle workers and the dispatcher sleep on.
+===============================================================================
+*/
+
+#include "ThreadPool.h"
+
+/* Takes the oldest request of the worker's own deque, or steals one. */
+static Mesg* TakeTask(ThreadPool* pool, int index)
+{
+    Deque* deque;
+    Mesg* msg = NULL;
+    int i;
+
+    for(i = 0; i < pool->threads && msg == NULL; i++)
+    {
+        deque = &pool->deques[(index + i) % pool->threads];
+
+        pthread_mutex_lock(&deque->lock);
+        if(deque->top != deque->bottom)
+        {
+            if(i == 0)
+            {
+                msg = deque->tasks[deque->top++ % DEQUE_SIZE];
+            }
+            else
+            {
+                // Thieves take from the other end, away from the owner.
+                msg = deque->tasks[--deque->bottom % DEQUE_SIZE];
+            }
+        }
+        pthread_mutex_unlock(&deque->lock);
+    }
+
+    if(msg != NULL)
+    {
+        pthread_mutex_lock(&pool->lock);
+        pool->pending--;
+        pthread_cond_signal(&pool->space);
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    return msg;
+}
+
+static void* RunWorker(void* arg)
+{
+    Worker* worker = arg;
+    ThreadPool* pool = worker->pool;
+    Mesg* msg;
+
+    while(1)
+    {
+        if((msg = TakeTask(pool, worker->index)) != NULL)
+        {
+            pool->task(msg, pool->queue);
+            free(msg);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        while(pool->pending == 0 && !pool->stopping)
+        {
+            pthread_cond_wait(&pool->work, &pool->lock);
+        }
+
+        if(pool->pending == 0 && pool->stopping)
+        {
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    return NULL;
+}
+
+ThreadPool* CreateThreadPool(int threads, int queue, Task task)
+{
+    ThreadPool* pool;
+    sigset_t block;
+    sigset_t old;
+    int i;
+
+    if(threads < 1 || threads > MAXTHREADS)
+    {
+        return NULL;
+    }
+
+    if((pool = calloc(1, sizeof(ThreadPool))) == NULL)
+    {
+        return NULL;
+    }
+
+    pool->threads = threads;
+    pool->queue = queue;
+    pool->task = task;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work, NULL);
+    pthread_cond_init(&pool->space, NULL);
+
+    for(i = 0; i < threads; i++)
+    {
+        pthread_mutex_init(&pool->deques[i].lock, NULL);
+    }
+
+    // The workers inherit a mask without SIGINT and SIGCHLD.
+    sigemptyset(&block);
+    sigaddset(&block, SIGINT);
+    sigaddset(&block, SIGCHLD);
+    pthread_sigmask(SIG_BLOCK, &block, &old);
+
+    for(i = 0; i < threads; i++)
+    {
+        pool->workers[i].pool = pool;
+        pool->workers[i].index = i;
+        if(pthread_create(&pool->workers[i].thread, NULL, RunWorker,
+            &pool->workers[i]) != 0)
+        {
+            break;
+        }
+    }
+
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    if(i < threads)
+    {
+        // Only join the threads that were started.
+        pool->threads = i;
+        DestroyThreadPool(pool);
+        return NULL;
+    }
+
+    return pool;
+}
+
+int SubmitTask(ThreadPool* pool, Mesg* msg)
+{
+    Deque* deque;
+    int i;
+
+    pthread_mutex_lock(&pool->lock);
+    while(pool->pending >= pool->threads * DEQUE_SIZE && !pool->stopping)
+    {
+        pthread_cond_wait(&pool->space, &pool->lock);
+    }
+
+    if(pool->stopping)
+    {
+        pthread_mutex_unlock(&pool->lock);
+        return -1;
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    // Deal the request to the next deque that has room.
+    for(i = 0; ; i++)
+    {
+        deque = &pool->deques[pool->next++ % pool->threads];
+
+        pthread_mutex_lock(&deque->lock);
+        if(deque->bottom - deque->top < DEQUE_SIZE)
+        {
+            deque->tasks[deque->bottom++ % DEQUE_SIZE] = msg;
+            pthread_mutex_unlock(&deque->lock);
+            break;
+        }
+        pthread_mutex_unlock(&deque->lock);
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->pending++;
+    pthread_cond_signal(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+
+    return 0;
+}
+
+void DestroyThreadPool(ThreadPool* pool)
+{
+    int i;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = 1;
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+
+    for(i = 0; i < pool->threads; i++)
+    {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+
+    for(i = 0; i < MAXTHREADS; i++)
+    {
+        pthread_mutex_destroy(&pool->deques[i].lock);
+    }
+
+    pthread_cond_destroy(&pool->space);
+    pthread_cond_destroy(&pool->work);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool);
+}
@@ -0,0 +1,159 @@
+/*
+===============================================================================
+SOURCE FILE:    ThreadPool.h
+                    Header file for the Server's work-stealing thread pool.
+
+PROGRAM:        Server
+
+FUNCTIONS:      ThreadPool* CreateThreadPool(int threads, int queue,
+                                             Task task)
+                int SubmitTask(ThreadPool* pool, Mesg* msg)
+                void DestroyThreadPool(ThreadPool* pool)
+
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER:     agent
+
+NOTES:
+An alternative to forking a process per request. One dispatcher thread reads
+the requests and hands them to a fixed number of worker threads. Every
+worker owns a deque of requests: the dispatcher deals the requests out
+round-robin, a worker serves its own deque oldest first and, once it is
+empty, steals the newest request from another worker's deque. A worker that
+is busy with a huge file therefore never holds up the small requests that
+were dealt to it.
+===============================================================================
+*/
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <pthread.h>
+#include "Utilities.h"
+
+#define DEQUE_SIZE      256     // Requests each worker may have waiting
+#define MAXTHREADS      64      // Largest thread pool
+
+/* Serves one request, the same interface as Process Client. */
+typedef int (*Task)(Mesg* msg, int queue);
+
+/* Requests waiting for one worker, guarded by its own lock. */
+typedef struct
+{
+    pthread_mutex_t lock;
+    Mesg* tasks[DEQUE_SIZE];
+    unsigned int top;           // Oldest request, taken by the owner
+    unsigned int bottom;        // One past the newest request
+} Deque;
+
+typedef struct ThreadPool ThreadPool;
+
+/* Handed to each worker thread. */
+typedef struct
+{
+    ThreadPool* pool;
+    int index;
+    pthread_t thread;
+} Worker;
+
+struct ThreadPool
+{
+    int threads;
+    int queue;                  // Message queue handed to the Task
+    Task task;
+    Deque deques[MAXTHREADS];
+    Worker workers[MAXTHREADS];
+    unsigned int next;          // Deque that receives the next request
+
+    pthread_mutex_t lock;       // Guards pending and stopping
+    pthread_cond_t work;        // Signalled when a request is submitted
+    pthread_cond_t space;       // Signalled when a request is taken
+    int pending;                // Requests waiting in all of the deques
+    int stopping;
+};
+
+/*
+===============================================================================
+FUNCTION:       Create Thread Pool
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      ThreadPool* CreateThreadPool(int threads, int queue,
+                                             Task task)
+
+PARAMETERS:     int threads
+                    Number of worker threads, 1 to MAXTHREADS.
+                int queue
+                    Message queue handed to the task with every request.
+                Task task
+                    Function that serves a request.
+
+RETURNS:        -Returns NULL if the pool could not be created.
+                -Returns the running pool on success.
+
+NOTES:
+The worker threads block SIGINT and SIGCHLD so that those signals interrupt
+the dispatcher's wait for requests instead.
+===============================================================================
+*/
+ThreadPool* CreateThreadPool(int threads, int queue, Task task);
+
+/*
+===============================================================================
+FUNCTION:       Submit Task
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int SubmitTask(ThreadPool* pool, Mesg* msg)
+
+PARAMETERS:     ThreadPool* pool
+                    The running pool.
+                Mesg* msg
+                    A request allocated with malloc, the pool frees it once
+                    it has been served.
+
+RETURNS:        -Returns -1 if the pool is stopping.
+                -Returns 0 once the request has been queued.
+
+NOTES:
+Called by the dispatcher only. Waits while every deque is full.
+===============================================================================
+*/
+int SubmitTask(ThreadPool* pool, Mesg* msg);
+
+/*
+===============================================================================
+FUNCTION:       Destroy Thread Pool
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void DestroyThreadPool(ThreadPool* pool)
+
+PARAMETERS:     ThreadPool* pool
+                    The running pool.
+
+RETURNS:        void
+
+NOTES:
+Lets the workers serve whatever is still queued, joins them and frees the
+pool.
+===============================================================================
+*/
+void DestroyThreadPool(ThreadPool* pool);
+
+#endif
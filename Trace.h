@@ -0,0 +1,148 @@
+/*
+===============================================================================
+SOURCE FILE:    Trace.h
+                    Header file for the per chunk latency traces.
+
+PROGRAM:        Client / Server / TraceView
+
+FUNCTIONS:      Trace* OpenTrace(const char* dir, int side, pid_t client,
+                      long request)
+                void TraceChunk(Trace* trace, TraceRecord* record)
+                void CloseTrace(Trace* trace)
+
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER:     agent
+
+NOTES:
+Tracing is opt-in at both ends. A Server started with -T dir numbers the
+chunks of every transfer in mesg_seq, and Send Message stamps each numbered
+chunk with the CLOCK_MONOTONIC time in mesg_sent just before it is queued.
+The two travel after the chunk's data (MESGSTAMP), traced chunks are that
+much shorter and untraced messages do not carry them at all.
+The Server writes one record per chunk into dir/<client>-<request>.server
+saying how long the chunk took to read, how long it then waited (credit or
+its turn in the scheduler) and how long msgsnd blocked. A Client started
+with -T dir writes dir/<pid>-<request>.client saying when each numbered chunk
+came off of the queue and how long it took to write out.
+
+The clock is shared by every process of the machine, so the two files of a
+transfer line up. TraceView turns them into latency histograms and a
+Chrome trace timeline.
+
+The files are written through stdio and are a header followed by records,
+native endian, meant to be read on the machine which wrote them.
+===============================================================================
+*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include "Utilities.h"
+
+#define TRACE_MAGIC         "MQTR"
+#define TRACE_SERVER        0       // Written by the Server
+#define TRACE_CLIENT        1       // Written by the Client
+
+/* Start of every trace file. */
+typedef struct
+{
+    char magic[4];              // TRACE_MAGIC
+    int32_t side;               // TRACE_SERVER or TRACE_CLIENT
+    int32_t pid;                // Process which wrote the trace
+    int32_t client;             // Client the transfer was for
+    int64_t request;            // mesg_id of the request
+} TraceHeader;
+
+/* One chunk of a transfer. */
+typedef struct
+{
+    uint32_t seq;               // mesg_seq of the chunk
+    uint32_t len;               // Bytes of the chunk
+    int64_t start;              // Server: the read began. Client: dequeued.
+    int64_t sent;               // mesg_sent, stamped before msgsnd
+    int64_t stage;              // Server: ns reading. Client: ns writing.
+    int64_t blocked;            // Server: ns inside of msgsnd. Client: 0.
+} TraceRecord;
+
+typedef struct
+{
+    FILE* fp;
+} Trace;
+
+/*
+===============================================================================
+FUNCTION:       Open Trace
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      Trace* OpenTrace(const char* dir, int side, pid_t client,
+                      long request)
+
+PARAMETERS:     const char* dir
+                    Directory the trace is written into.
+                int side
+                    TRACE_SERVER or TRACE_CLIENT.
+                pid_t client
+                    The Client of the transfer.
+                long request
+                    The mesg_id of the request.
+
+RETURNS:        -Returns NULL if the file cannot be created, the transfer
+                    then goes on untraced.
+                -Returns the trace with its header written.
+===============================================================================
+*/
+Trace* OpenTrace(const char* dir, int side, pid_t client, long request);
+
+/*
+===============================================================================
+FUNCTION:       Trace Chunk
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void TraceChunk(Trace* trace, TraceRecord* record)
+
+PARAMETERS:     Trace* trace
+                    The transfer's trace, NULL when it is not traced.
+                TraceRecord* record
+                    The chunk, appended to the file.
+
+RETURNS:        void
+===============================================================================
+*/
+void TraceChunk(Trace* trace, TraceRecord* record);
+
+/*
+===============================================================================
+FUNCTION:       Close Trace
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void CloseTrace(Trace* trace)
+
+PARAMETERS:     Trace* trace
+                    The transfer's trace, NULL when it is not traced.
+
+RETURNS:        void
+===============================================================================
+*/
+void CloseTrace(Trace* trace);
+
+#endif
@@ -0,0 +1,345 @@
+/*
+===============================================================================
+SOURCE FILE:    TraceView.c
+                    Definition file for the viewer of the latency traces.
+
+PROGRAM:        TraceView
+
+FUNCTIONS:      int main(int argc, char** argv)
+                void TraceViewHelp(void)
+                int LoadTrace(const char* path, TraceFile* file)
+                void CollectStages(TraceFile* file, Stage* stages)
+                int AddSample(Stage* stage, long long ns)
+                void ReportStage(Stage* stage)
+                int WriteChromeTrace(const char* path, TraceFile* files,
+                      int count)
+
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER:     agent
+
+NOTES:
+Every trace is loaded whole, a transfer has one record per chunk and even a
+large file at a low priority stays within a few hundred megabytes.
+===============================================================================
+*/
+
+#include "TraceView.h"
+
+static const char* stageNames[TRACE_STAGES] =
+    { "read", "wait", "send", "queue", "write" };
+
+static int CompareSamples(const void* a, const void* b)
+{
+    long long x = *(const long long*)a;
+    long long y = *(const long long*)b;
+
+    return (x > y) - (x < y);
+}
+
+static double Percentile(Stage* stage, double p)
+{
+    size_t i = (size_t)(p * (stage->count - 1) + 0.5);
+
+    return stage->samples[i] / 1e3;
+}
+
+int main(int argc, char** argv)
+{
+    Stage stages[TRACE_STAGES];
+    TraceFile* files;
+    const char* timeline = NULL;
+    int count = 0;
+    int opt;
+    int i;
+
+    while((opt = getopt(argc, argv, "c:")) != -1)
+    {
+        switch(opt)
+        {
+        case 'c':
+            timeline = optarg;
+            break;
+        default:
+            TraceViewHelp();
+            return 1;
+        }
+    }
+
+    if(optind >= argc)
+    {
+        TraceViewHelp();
+        return 1;
+    }
+
+    if((files = calloc(argc - optind, sizeof(TraceFile))) == NULL)
+    {
+        return 1;
+    }
+
+    memset(stages, 0, sizeof(stages));
+    for(i = 0; i < TRACE_STAGES; i++)
+    {
+        stages[i].name = stageNames[i];
+    }
+
+    for(i = optind; i < argc; i++)
+    {
+        if(LoadTrace(argv[i], &files[count]) < 0)
+        {
+            printf("Skipping %s, it is not a trace.\n", argv[i]);
+            continue;
+        }
+
+        CollectStages(&files[count], stages);
+        count++;
+    }
+
+    if(count == 0)
+    {
+        return 1;
+    }
+
+    printf("%d traces\n", count);
+    for(i = 0; i < TRACE_STAGES; i++)
+    {
+        ReportStage(&stages[i]);
+    }
+
+    if(timeline != NULL && WriteChromeTrace(timeline, files, count) < 0)
+    {
+        printf("Cannot write %s.\n", timeline);
+        return 1;
+    }
+
+    return 0;
+}
+
+void TraceViewHelp(void)
+{
+    printf("Usage: ./TraceView [-c timeline.json] trace...\n");
+    printf("  -c file    also write a Chrome trace JSON timeline.\n");
+}
+
+int LoadTrace(const char* path, TraceFile* file)
+{
+    TraceRecord record;
+    TraceRecord* grown;
+    size_t size = 0;
+    FILE* fp;
+
+    memset(file, 0, sizeof(TraceFile));
+    file->path = path;
+
+    if((fp = fopen(path, "r")) == NULL)
+    {
+        return -1;
+    }
+
+    if(fread(&file->header, sizeof(TraceHeader), 1, fp) != 1 ||
+        memcmp(file->header.magic, TRACE_MAGIC, sizeof(file->header.magic)))
+    {
+        fclose(fp);
+        return -1;
+    }
+
+    while(fread(&record, sizeof(record), 1, fp) == 1)
+    {
+        if(file->count == size)
+        {
+            size = size ? size * 2 : 1024;
+            if((grown = realloc(file->records, size * sizeof(record))) == NULL)
+                break;
+            file->records = grown;
+        }
+
+        file->records[file->count++] = record;
+    }
+
+    fclose(fp);
+    return 0;
+}
+
+void CollectStages(TraceFile* file, Stage* stages)
+{
+    TraceRecord* r;
+    size_t i;
+
+    for(i = 0; i < file->count; i++)
+    {
+        r = &file->records[i];
+
+        if(file->header.side == TRACE_SERVER)
+        {
+            AddSample(&stages[0], r->stage);
+            AddSample(&stages[1], r->sent - r->start - r->stage);
+            AddSample(&stages[2], r->blocked);
+        }
+        else
+        {
+            AddSample(&stages[3], r->start - r->sent);
+            AddSample(&stages[4], r->stage);
+        }
+    }
+}
+
+int AddSample(Stage* stage, long long ns)
+{
+    long long* grown;
+    size_t size;
+
+    if(stage->count == stage->size)
+    {
+        size = stage->size ? stage->size * 2 : 1024;
+        if((grown = realloc(stage->samples, size * sizeof(long long))) == NULL)
+            return -1;
+
+        stage->samples = grown;
+        stage->size = size;
+    }
+
+    stage->samples[stage->count++] = (ns > 0) ? ns : 0;
+    return 0;
+}
+
+void ReportStage(Stage* stage)
+{
+    size_t buckets[TRACE_BUCKETS];
+    size_t most = 0;
+    double total = 0;
+    long long us;
+    size_t i;
+    int b;
+
+    if(stage->count == 0)
+    {
+        printf("\n%-6s no chunks\n", stage->name);
+        return;
+    }
+
+    qsort(stage->samples, stage->count, sizeof(long long), CompareSamples);
+
+    memset(buckets, 0, sizeof(buckets));
+    for(i = 0; i < stage->count; i++)
+    {
+        total += stage->samples[i];
+
+        // Bucket b holds the samples up to 2^b microseconds.
+        us = stage->samples[i] / 1000;
+        for(b = 0; b < TRACE_BUCKETS - 1 && (1LL << b) <= us; b++)
+        {
+        }
+
+        if(++buckets[b] > most)
+            most = buckets[b];
+    }
+
+    printf("\n%-6s %zu chunks  p50 %.1f us  p90 %.1f us  p99 %.1f us  "
+        "max %.1f us  total %.3f s\n", stage->name, stage->count,
+        Percentile(stage, 0.5), Percentile(stage, 0.9),
+        Percentile(stage, 0.99), Percentile(stage, 1.0), total / 1e9);
+
+    for(b = 0; b < TRACE_BUCKETS; b++)
+    {
+        if(buckets[b] == 0)
+            continue;
+
+        printf("  < %10lld us %10zu ", 1LL << b, buckets[b]);
+        for(i = 0; i < (buckets[b] * 40 + most - 1) / most; i++)
+            putchar('#');
+        putchar('\n');
+    }
+}
+
+int WriteChromeTrace(const char* path, TraceFile* files, int count)
+{
+    TraceFile* file;
+    TraceRecord* r;
+    long long base = -1;
+    const char* comma = "";
+    FILE* fp;
+    size_t i;
+    int f;
+
+    // Stage name, start and length of every event of a record, in ns.
+    const char* names[3];
+    long long starts[3];
+    long long lengths[3];
+    int events;
+    int e;
+
+    for(f = 0; f < count; f++)
+    {
+        for(i = 0; i < files[f].count; i++)
+        {
+            r = &files[f].records[i];
+            if(base < 0 || r->sent < base)
+                base = r->sent;
+            if(r->start < base)
+                base = r->start;
+        }
+    }
+
+    if((fp = fopen(path, "w")) == NULL)
+    {
+        return -1;
+    }
+
+    fprintf(fp, "{\"traceEvents\":[");
+    for(f = 0; f < count; f++)
+    {
+        file = &files[f];
+
+        fprintf(fp, "%s\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+            "\"args\":{\"name\":\"%s %d\"}}", comma, file->header.pid,
+            (file->header.side == TRACE_SERVER) ? "Server" : "Client",
+            file->header.pid);
+        comma = ",";
+
+        for(i = 0; i < file->count; i++)
+        {
+            r = &file->records[i];
+
+            if(file->header.side == TRACE_SERVER)
+            {
+                names[0] = "read";
+                starts[0] = r->start;
+                lengths[0] = r->stage;
+                names[1] = "wait";
+                starts[1] = r->start + r->stage;
+                lengths[1] = r->sent - starts[1];
+                names[2] = "send";
+                starts[2] = r->sent;
+                lengths[2] = r->blocked;
+                events = 3;
+            }
+            else
+            {
+                names[0] = "queue";
+                starts[0] = r->sent;
+                lengths[0] = r->start - r->sent;
+                names[1] = "write";
+                starts[1] = r->start;
+                lengths[1] = r->stage;
+                events = 2;
+            }
+
+            for(e = 0; e < events; e++)
+            {
+                fprintf(fp, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,"
+                    "\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,"
+                    "\"args\":{\"seq\":%u,\"len\":%u,\"request\":%lld}}",
+                    names[e], file->header.pid, file->header.client,
+                    (starts[e] - base) / 1e3,
+                    (lengths[e] > 0 ? lengths[e] : 0) / 1e3,
+                    r->seq, r->len, (long long)file->header.request);
+            }
+        }
+    }
+    fprintf(fp, "\n]}\n");
+
+    return fclose(fp);
+}
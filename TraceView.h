@@ -0,0 +1,236 @@
+/*
+===============================================================================
+SOURCE FILE:    TraceView.h
+                    Header file for the viewer of the latency traces.
+
+PROGRAM:        TraceView
+
+FUNCTIONS:      int main(int argc, char** argv)
+                void TraceViewHelp(void)
+                int LoadTrace(const char* path, TraceFile* file)
+                void CollectStages(TraceFile* file, Stage* stages)
+                int AddSample(Stage* stage, long long ns)
+                void ReportStage(Stage* stage)
+                int WriteChromeTrace(const char* path, TraceFile* files,
+                      int count)
+
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER:     agent
+
+NOTES:
+Reads the trace files written by the Server and Client with -T (see
+Trace.h) and splits the life of every chunk into stages:
+    read    Server, reading the chunk from the file or the cache.
+    wait    Server, from the end of the read until the send began: waiting
+            for credit, or for its turn under the scheduler.
+    send    Server, inside of msgsnd, mostly waiting on a full queue.
+    queue   Client, from the send until the chunk came off of the queue.
+    write   Client, writing the chunk out, stdout flushes included.
+Each stage is printed as a power of two histogram in microseconds with its
+percentiles, which tells where the tail of the latency comes from.
+
+With -c the chunks are also written as a Chrome trace JSON timeline, one
+row per transfer, which chrome://tracing or Perfetto opens.
+
+    ./TraceView [-c timeline.json] traces/4242-0.server traces/4242-0.client
+===============================================================================
+*/
+
+#ifndef TRACEVIEW_H
+#define TRACEVIEW_H
+
+#include "Trace.h"
+
+#define TRACE_STAGES        5       // read, wait, send, queue, write
+#define TRACE_BUCKETS       32      // Power of two microsecond buckets
+
+/* One trace file, loaded whole. */
+typedef struct
+{
+    const char* path;
+    TraceHeader header;
+    TraceRecord* records;
+    size_t count;
+} TraceFile;
+
+/* The samples of one stage of every chunk, in nanoseconds. */
+typedef struct
+{
+    const char* name;
+    long long* samples;
+    size_t count;
+    size_t size;                // Room in samples
+} Stage;
+
+/*
+===============================================================================
+FUNCTION:       Main
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int main(int argc, char** argv)
+
+PARAMETERS:     int argc
+                    The number of arguments received from command-line.
+                char** argv
+                    [-c timeline.json] followed by the trace files.
+
+RETURNS:        -Returns 1 if no trace could be read or the timeline could
+                    not be written.
+                -Returns 0 otherwise.
+===============================================================================
+*/
+int main(int argc, char** argv);
+
+/*
+===============================================================================
+FUNCTION:       Trace View Help
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void TraceViewHelp(void)
+
+PARAMETERS:     void
+
+RETURNS:        void
+===============================================================================
+*/
+void TraceViewHelp(void);
+
+/*
+===============================================================================
+FUNCTION:       Load Trace
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int LoadTrace(const char* path, TraceFile* file)
+
+PARAMETERS:     const char* path
+                    A file written by Open Trace.
+                TraceFile* file
+                    Filled with the header and every whole record.
+
+RETURNS:        -Returns -1 if the file cannot be read or is not a trace.
+                -Returns 0 otherwise, a trace cut short keeps the records
+                    before the cut.
+===============================================================================
+*/
+int LoadTrace(const char* path, TraceFile* file);
+
+/*
+===============================================================================
+FUNCTION:       Collect Stages
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void CollectStages(TraceFile* file, Stage* stages)
+
+PARAMETERS:     TraceFile* file
+                    A loaded trace.
+                Stage* stages
+                    The TRACE_STAGES stages, its chunks are added to them.
+
+RETURNS:        void
+===============================================================================
+*/
+void CollectStages(TraceFile* file, Stage* stages);
+
+/*
+===============================================================================
+FUNCTION:       Add Sample
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int AddSample(Stage* stage, long long ns)
+
+PARAMETERS:     Stage* stage
+                    The stage.
+                long long ns
+                    How long one chunk spent in it, below 0 counts as 0.
+
+RETURNS:        -Returns -1 when out of memory.
+                -Returns 0 otherwise.
+===============================================================================
+*/
+int AddSample(Stage* stage, long long ns);
+
+/*
+===============================================================================
+FUNCTION:       Report Stage
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void ReportStage(Stage* stage)
+
+PARAMETERS:     Stage* stage
+                    The stage, its samples are sorted.
+
+RETURNS:        void
+
+NOTES:
+Prints the p50/p90/p99/max and total of the stage, then the histogram with
+one row per power of two of microseconds which holds any sample.
+===============================================================================
+*/
+void ReportStage(Stage* stage);
+
+/*
+===============================================================================
+FUNCTION:       Write Chrome Trace
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int WriteChromeTrace(const char* path, TraceFile* files,
+                      int count)
+
+PARAMETERS:     const char* path
+                    The JSON file to write.
+                TraceFile* files
+                    The loaded traces.
+                int count
+                    How many there are.
+
+RETURNS:        -Returns -1 if the file cannot be written.
+                -Returns 0 otherwise.
+
+NOTES:
+Every stage of every chunk becomes a complete ("X") event. The Server's
+stages go in a row per transfer under the Server process, the Client's under
+the Client process. The times start at the earliest chunk of all the traces.
+===============================================================================
+*/
+int WriteChromeTrace(const char* path, TraceFile* files, int count);
+
+#endif
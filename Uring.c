@@ -0,0 +1,347 @@
+/*
+===============================================================================
+SOURCE FILE:    Uring.c
+                    Definition file for the Server's io_uring read pipeline.
+
+PROGRAM:        Server
+
+FUNCTIONS:      UringReader* OpenUringReader(int fd, off_t offset,
+                                             size_t size)
+                ssize_t UringRead(UringReader* reader, char* where,
+                                  size_t size)
+                void CloseUringReader(UringReader* reader)
+                static int SubmitUringRead(UringReader* reader, int slot)
+                static int QueueUringRead(UringReader* reader, int slot)
+                static int WaitUringRead(UringReader* reader)
+
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER:     agent
+
+NOTES:
+Every read carries the index of its buffer as its user_data. The reads may
+complete in any order, the buffers are still handed out in the order their
+reads were submitted.
+
+A read may come back short before the end of the file. Its buffer is then
+read again from where it stopped, so only a read reaching the size the file
+had when opened, or one returning nothing, ends the file.
+===============================================================================
+*/
+
+#include "Uring.h"
+
+#ifndef USE_URING
+UringReader* OpenUringReader(int fd, off_t offset, size_t size)
+{
+    (void)fd;
+    (void)offset;
+    (void)size;
+
+    // Built without io_uring, the caller reads the file itself.
+    return NULL;
+}
+
+ssize_t UringRead(UringReader* reader, char* where, size_t size)
+{
+    (void)reader;
+    (void)where;
+    (void)size;
+
+    return -1;
+}
+
+void CloseUringReader(UringReader* reader)
+{
+    free(reader);
+}
+#else
+static int SubmitUringRead(UringReader* reader, int slot);
+static int QueueUringRead(UringReader* reader, int slot);
+static int WaitUringRead(UringReader* reader);
+
+UringReader* OpenUringReader(int fd, off_t offset, size_t size)
+{
+    struct io_uring_params* p;
+    struct iovec iov[URING_DEPTH];
+    struct stat st;
+    UringReader* reader;
+    int i;
+
+    if(fstat(fd, &st) < 0 || (reader = calloc(1, sizeof(UringReader))) == NULL)
+    {
+        return NULL;
+    }
+
+    p = &reader->params;
+    reader->fd = fd;
+    reader->size = size;
+    reader->next = offset;
+    reader->end = st.st_size;
+    reader->sqMap = reader->cqMap = MAP_FAILED;
+    reader->sqes = MAP_FAILED;
+
+    if((reader->ring = syscall(__NR_io_uring_setup, URING_DEPTH, p)) < 0)
+    {
+        free(reader);
+        return NULL;
+    }
+
+    reader->sqSize = p->sq_off.array + p->sq_entries * sizeof(unsigned);
+    reader->cqSize = p->cq_off.cqes +
+        p->cq_entries * sizeof(struct io_uring_cqe);
+
+    // Newer kernels map both rings at once.
+    if(p->features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if(reader->cqSize > reader->sqSize)
+            reader->sqSize = reader->cqSize;
+        reader->cqSize = reader->sqSize;
+    }
+
+    reader->sqMap = mmap(NULL, reader->sqSize, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, reader->ring, IORING_OFF_SQ_RING);
+
+    if(p->features & IORING_FEAT_SINGLE_MMAP)
+    {
+        reader->cqMap = reader->sqMap;
+    }
+    else
+    {
+        reader->cqMap = mmap(NULL, reader->cqSize, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, reader->ring, IORING_OFF_CQ_RING);
+    }
+
+    reader->sqesSize = p->sq_entries * sizeof(struct io_uring_sqe);
+    reader->sqes = mmap(NULL, reader->sqesSize, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, reader->ring, IORING_OFF_SQES);
+
+    if(reader->sqMap == MAP_FAILED || reader->cqMap == MAP_FAILED ||
+        reader->sqes == MAP_FAILED ||
+        (reader->pool = malloc(size * URING_DEPTH)) == NULL)
+    {
+        CloseUringReader(reader);
+        return NULL;
+    }
+
+    for(i = 0; i < URING_DEPTH; i++)
+    {
+        iov[i].iov_base = reader->pool + i * size;
+        iov[i].iov_len = size;
+    }
+
+    // Registered buffers are pinned once instead of on every read.
+    reader->fixed = (syscall(__NR_io_uring_register, reader->ring,
+        IORING_REGISTER_BUFFERS, iov, URING_DEPTH) == 0);
+
+    for(i = 0; i < URING_DEPTH; i++)
+    {
+        if(SubmitUringRead(reader, i) < 0)
+        {
+            CloseUringReader(reader);
+            return NULL;
+        }
+    }
+
+    return reader;
+}
+
+ssize_t UringRead(UringReader* reader, char* where, size_t size)
+{
+    size_t copied = 0;
+    size_t n;
+    int head;
+
+    while(copied < size)
+    {
+        head = reader->head;
+
+        while(reader->pending[head])
+        {
+            if(WaitUringRead(reader) < 0)
+                return copied > 0 ? (ssize_t)copied : -1;
+        }
+
+        if(reader->result[head] < 0)
+        {
+            errno = -reader->result[head];
+            return copied > 0 ? (ssize_t)copied : -1;
+        }
+
+        if(reader->used == (size_t)reader->result[head])
+        {
+            // A short buffer is the end of the file.
+            if((size_t)reader->result[head] < reader->size)
+                break;
+
+            if(SubmitUringRead(reader, head) < 0)
+                return copied > 0 ? (ssize_t)copied : -1;
+
+            reader->head = (head + 1) % URING_DEPTH;
+            reader->used = 0;
+            continue;
+        }
+
+        n = reader->result[head] - reader->used;
+        if(n > size - copied)
+            n = size - copied;
+
+        memcpy(where + copied, reader->pool + head * reader->size +
+            reader->used, n);
+        reader->used += n;
+        copied += n;
+    }
+
+    return copied;
+}
+
+void CloseUringReader(UringReader* reader)
+{
+    if(reader == NULL)
+    {
+        return;
+    }
+
+    // The kernel may still be writing into the buffers.
+    while(reader->inflight > 0 && WaitUringRead(reader) == 0)
+    {
+    }
+
+    if(reader->sqes != MAP_FAILED)
+        munmap(reader->sqes, reader->sqesSize);
+    if(reader->cqMap != MAP_FAILED && reader->cqMap != reader->sqMap)
+        munmap(reader->cqMap, reader->cqSize);
+    if(reader->sqMap != MAP_FAILED)
+        munmap(reader->sqMap, reader->sqSize);
+
+    close(reader->ring);
+    free(reader->pool);
+    free(reader);
+}
+
+/* Reads the next part of the file into the buffer in slot. */
+static int SubmitUringRead(UringReader* reader, int slot)
+{
+    // Nothing is left to read past the end.
+    if(reader->eof)
+    {
+        reader->pending[slot] = 0;
+        reader->result[slot] = 0;
+        return 0;
+    }
+
+    reader->offset[slot] = reader->next;
+    reader->filled[slot] = 0;
+
+    if(QueueUringRead(reader, slot) < 0)
+    {
+        return -1;
+    }
+
+    reader->next += reader->size;
+    return 0;
+}
+
+/* Reads the rest of the buffer in slot, past what it already holds. */
+static int QueueUringRead(UringReader* reader, int slot)
+{
+    struct io_uring_params* p = &reader->params;
+    char* sq = reader->sqMap;
+    struct io_uring_sqe* sqe;
+    unsigned tail;
+    unsigned index;
+
+    tail = *(unsigned*)(sq + p->sq_off.tail);
+    index = tail & *(unsigned*)(sq + p->sq_off.ring_mask);
+
+    sqe = &reader->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = reader->fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    sqe->fd = reader->fd;
+    sqe->off = reader->offset[slot] + reader->filled[slot];
+    sqe->addr = (unsigned long)(reader->pool + slot * reader->size +
+        reader->filled[slot]);
+    sqe->len = reader->size - reader->filled[slot];
+    sqe->buf_index = slot;
+    sqe->user_data = slot;
+
+    ((unsigned*)(sq + p->sq_off.array))[index] = index;
+    __atomic_store_n((unsigned*)(sq + p->sq_off.tail), tail + 1,
+        __ATOMIC_RELEASE);
+
+    if(syscall(__NR_io_uring_enter, reader->ring, 1, 0, 0, NULL, 0) < 0)
+    {
+        return -1;
+    }
+
+    reader->pending[slot] = 1;
+    reader->inflight++;
+    return 0;
+}
+
+/* Waits for at least one read to complete and records every completion. */
+static int WaitUringRead(UringReader* reader)
+{
+    struct io_uring_params* p = &reader->params;
+    char* cq = reader->cqMap;
+    struct io_uring_cqe* cqe;
+    unsigned head;
+    unsigned tail;
+    int slot;
+
+    head = *(unsigned*)(cq + p->cq_off.head);
+    tail = __atomic_load_n((unsigned*)(cq + p->cq_off.tail), __ATOMIC_ACQUIRE);
+
+    while(head == tail)
+    {
+        if(syscall(__NR_io_uring_enter, reader->ring, 0, 1,
+            IORING_ENTER_GETEVENTS, NULL, 0) < 0 && errno != EINTR)
+        {
+            return -1;
+        }
+
+        tail = __atomic_load_n((unsigned*)(cq + p->cq_off.tail),
+            __ATOMIC_ACQUIRE);
+    }
+
+    for(; head != tail; head++)
+    {
+        cqe = (struct io_uring_cqe*)(cq + p->cq_off.cqes) +
+            (head & *(unsigned*)(cq + p->cq_off.ring_mask));
+        slot = cqe->user_data;
+
+        reader->pending[slot] = 0;
+        reader->inflight--;
+
+        if(cqe->res < 0)
+        {
+            reader->result[slot] = cqe->res;
+            continue;
+        }
+
+        reader->filled[slot] += cqe->res;
+        reader->result[slot] = reader->filled[slot];
+
+        if(reader->filled[slot] == reader->size)
+            continue;
+
+        // Short of the end the file was opened at, read the rest.
+        if(cqe->res > 0 &&
+            reader->offset[slot] + (off_t)reader->filled[slot] < reader->end)
+        {
+            if(QueueUringRead(reader, slot) < 0)
+                reader->result[slot] = -errno;
+            continue;
+        }
+
+        reader->eof = 1;
+    }
+
+    __atomic_store_n((unsigned*)(cq + p->cq_off.head), head,
+        __ATOMIC_RELEASE);
+    return 0;
+}
+#endif
@@ -0,0 +1,171 @@
+/*
+===============================================================================
+SOURCE FILE:    Uring.h
+                    Header file for the Server's io_uring read pipeline.
+
+PROGRAM:        Server
+
+FUNCTIONS:      UringReader* OpenUringReader(int fd, off_t offset,
+                                             size_t size)
+                ssize_t UringRead(UringReader* reader, char* where,
+                                  size_t size)
+                void CloseUringReader(UringReader* reader)
+
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER:     agent
+
+NOTES:
+Reading the file between the sends makes every chunk wait for the disk and
+then for the queue in turn. The reader keeps URING_DEPTH reads of the file in
+flight through io_uring, each into its own buffer of a small pool, so while a
+chunk is being sent the next ones are already being read. The buffers are
+handed out in file order and every buffer is read again further on as soon
+as it has been used up.
+
+io_uring is driven with the raw system calls and the kernel's own header, no
+library is needed. It is only built with USE_URING (see the makefile),
+without it Open Uring Reader always fails and the files are read with pread.
+The buffers are registered with the ring when the locked memory limit
+allows it, otherwise plain reads are used.
+===============================================================================
+*/
+
+#ifndef URING_H
+#define URING_H
+
+#include "Utilities.h"
+
+#define URING_DEPTH     4       // Reads in flight ahead of the sender
+
+#ifdef USE_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+/* The ring, its buffers and how far the file has been read. */
+typedef struct UringReader
+{
+#ifdef USE_URING
+    int ring;                           // io_uring descriptor
+    int fd;                             // The file read
+    int fixed;                          // The buffers are registered
+    struct io_uring_params params;
+    void* sqMap;                        // Submission ring
+    size_t sqSize;
+    void* cqMap;                        // Completion ring, may be sqMap
+    size_t cqSize;
+    struct io_uring_sqe* sqes;
+    size_t sqesSize;
+    char* pool;                         // URING_DEPTH buffers of size bytes
+    size_t size;
+    int pending[URING_DEPTH];           // Read of the buffer in flight
+    int result[URING_DEPTH];            // Bytes read into it, -errno
+    off_t offset[URING_DEPTH];          // Where in the file it was read from
+    size_t filled[URING_DEPTH];         // Bytes read so far, short reads
+                                        // are read again for the rest
+    int inflight;
+    int head;                           // Buffer being handed out
+    size_t used;                        // Bytes of it handed out
+    off_t next;                         // Offset of the next read submitted
+    off_t end;                          // Size of the file when opened
+    int eof;                            // A read reached the end of the file
+#else
+    int unused;
+#endif
+} UringReader;
+
+/*
+===============================================================================
+FUNCTION:       Open Uring Reader
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      UringReader* OpenUringReader(int fd, off_t offset,
+                                             size_t size)
+
+PARAMETERS:     int fd
+                    The regular file to read.
+                off_t offset
+                    Where in the file to start.
+                size_t size
+                    Bytes read at once into each buffer, normally
+                    messageData.
+
+RETURNS:        -Returns NULL when io_uring cannot be used.
+                -Returns the reader with its first reads submitted.
+
+NOTES:
+The kernel may refuse io_uring (too old, disabled or built without
+USE_URING), the caller then reads the file by itself.
+===============================================================================
+*/
+UringReader* OpenUringReader(int fd, off_t offset, size_t size);
+
+/*
+===============================================================================
+FUNCTION:       Uring Read
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      ssize_t UringRead(UringReader* reader, char* where,
+                                  size_t size)
+
+PARAMETERS:     UringReader* reader
+                    The reader.
+                char* where
+                    Where to copy the bytes.
+                size_t size
+                    Most bytes to copy.
+
+RETURNS:        -Returns -1 if a read failed before any byte was copied.
+                -Returns 0 at the end of the file.
+                -Returns the number of bytes copied.
+
+NOTES:
+Only waits when the next bytes have not been read yet. After a failure the
+caller may continue with pread at the offset reached so far, every byte
+handed out is in file order.
+===============================================================================
+*/
+ssize_t UringRead(UringReader* reader, char* where, size_t size);
+
+/*
+===============================================================================
+FUNCTION:       Close Uring Reader
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      void CloseUringReader(UringReader* reader)
+
+PARAMETERS:     UringReader* reader
+                    The reader, may be NULL.
+
+RETURNS:        void
+
+NOTES:
+Waits for the reads still in flight before the buffers are freed, the file
+itself is left open.
+===============================================================================
+*/
+void CloseUringReader(UringReader* reader);
+
+#endif
@@ -51,26 +51,49 @@ inside of the Utilities files.
 
 #include "Utilities.h"
 
+int msgQueue;
+int rc;
+size_t messageData = MAXMESSAGEDATA;
+
+struct sigaction sa;
+struct sigaction oldint;
+
+/* Shared by Read Message and Read Message No Wait. */
+static int ReceiveMessage(int queue, Mesg* msg, long msg_type, int flags)
+{
+    ssize_t n;
+
+    n = msgrcv(queue, &msg->mesg_type, MESGSIZE(messageData), msg_type,
+        flags);
+
+    return ReceivedMessage(msg, n);
+}
+
 int ReadMessage(int queue, Mesg* msg, long msg_type)
 {
-    rc = msgrcv(queue,msg,sizeof(msg->mesg_data),msg_type,0);
-    if(rc < 0)
-    {
-        return -1;
-    }
+    return ReceiveMessage(queue, msg, msg_type, 0);
+}
 
-    return 0;
+int ReadMessageNoWait(int queue, Mesg* msg, long msg_type)
+{
+    return ReceiveMessage(queue, msg, msg_type, IPC_NOWAIT);
 }
 
 int SendMessage(int queue, Mesg* msg)
 {
-    msg->mesg_len = strlen(msg->mesg_data);
-    
     /* This will keep trying to send messages the message queue if there are 
         too many messages in the queue. */
-    rc = msgsnd(queue, msg, sizeof(msg->mesg_data), 0);
+    if (msgsnd(queue, &msg->mesg_type, StampMessage(msg), 0) < 0)
+    {
+        return -1;
+    }
 
-    if (rc < 0)
+    return 0;
+}
+
+int SendMessageNoWait(int queue, Mesg* msg)
+{
+    if (msgsnd(queue, &msg->mesg_type, StampMessage(msg), IPC_NOWAIT) < 0)
     {
         return -1;
     }
@@ -80,8 +103,7 @@ int SendMessage(int queue, Mesg* msg)
 
 int SendFinalMessage(int queue, Mesg* msg)
 {
-    msg->mesg_data[0] = '\0';
-    msg->mesg_data[1] = '\0';
+    msg->mesg_len = 0;
     return SendMessage(queue, msg);
 }
 
@@ -99,16 +121,135 @@ int OpenQueue(void)
 {
     key_t key;
 
-    key = ftok("Info", 'a');
+    key = ftok(MSGKEY_PATH, MSGKEY_ID);
     msgQueue = msgget(key, 0644|IPC_CREAT);
 
     if (msgQueue < 0) {
         return -1;
     }
 
+    messageData = QueueMessageLimit(msgQueue);
+
     return 0;
 }
 
+size_t QueueMessageLimit(int queue)
+{
+    struct msqid_ds info;
+    long limit;
+
+    limit = ReadSystemLimit(MSGMAX_PATH);
+
+    if(msgctl(queue, IPC_STAT, &info) == 0 &&
+        (limit < 0 || (long)(info.msg_qbytes / MESG_QUEUE_DEPTH) < limit))
+    {
+        limit = info.msg_qbytes / MESG_QUEUE_DEPTH;
+    }
+
+    if(limit <= (long)MESGHEADER)
+    {
+        return MAXMESSAGEDATA;
+    }
+
+    return limit - MESGHEADER;
+}
+
+int QueueLength(int queue)
+{
+    struct msqid_ds info;
+
+    if(msgctl(queue, IPC_STAT, &info) < 0)
+    {
+        return -1;
+    }
+
+    return info.msg_qnum;
+}
+
+long ReadSystemLimit(const char* path)
+{
+    FILE* fp;
+    long value;
+
+    if((fp = fopen(path, "r")) == NULL)
+    {
+        return -1;
+    }
+
+    if(fscanf(fp, "%ld", &value) != 1)
+    {
+        value = -1;
+    }
+
+    fclose(fp);
+    return value;
+}
+
+Mesg* CreateMessage(void)
+{
+    Mesg* msg;
+
+    if((msg = malloc(offsetof(Mesg, mesg_data) + messageData + 1)) != NULL)
+    {
+        msg->mesg_id = 0;
+        msg->mesg_seq = 0;
+    }
+
+    return msg;
+}
+
+size_t StampMessage(Mesg* msg)
+{
+    if(msg->mesg_seq == 0)
+        return MESGSIZE(msg->mesg_len);
+
+    msg->mesg_sent = MonotonicNs();
+
+    /* Without room for the stamp the chunk goes out untraced. */
+    if(msg->mesg_len + MESGSTAMP > messageData)
+        return MESGSIZE(msg->mesg_len);
+
+    memcpy(msg->mesg_data + msg->mesg_len, &msg->mesg_seq, MESGSTAMP);
+    return MESGSIZE(msg->mesg_len + MESGSTAMP);
+}
+
+int ReceivedMessage(Mesg* msg, ssize_t n)
+{
+    if(n < (ssize_t)MESGHEADER)
+    {
+        if(n >= 0)
+            errno = EBADMSG;
+
+        return -1;
+    }
+    n -= MESGHEADER;
+
+    /* Exactly a stamp past the data is a traced message. */
+    msg->mesg_seq = 0;
+    if(msg->mesg_len + MESGSTAMP == (size_t)n)
+    {
+        memcpy(&msg->mesg_seq, msg->mesg_data + msg->mesg_len, MESGSTAMP);
+    }
+    /* Trust the received byte count over the length inside the message. */
+    else if(msg->mesg_len > (size_t)n)
+    {
+        msg->mesg_len = n;
+    }
+
+    /* Create Message leaves room for the terminator. */
+    msg->mesg_data[msg->mesg_len] = '\0';
+
+    return 0;
+}
+
+long long MonotonicNs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
 FILE* OpenFile(const char* fileName)
 {
     FILE *fp;
@@ -7,9 +7,18 @@ SOURCE FILE:    Utilities.h
 PROGRAM:        Client / Server
 
 FUNCTIONS:      int ReadMessage(int queue, Mesg* msg, long msg_type)
+                int ReadMessageNoWait(int queue, Mesg* msg, long msg_type)
                 int SendMessage(int queue, Mesg* msg)
+                int SendMessageNoWait(int queue, Mesg* msg)
                 int SendFinalMessage(int queue, Mesg* msg)
                 int OpenQueue(void)
+                size_t QueueMessageLimit(int queue)
+                int QueueLength(int queue)
+                long ReadSystemLimit(const char* path)
+                Mesg* CreateMessage(void)
+                size_t StampMessage(Mesg* msg)
+                int ReceivedMessage(Mesg* msg, ssize_t n)
+                long long MonotonicNs(void)
                 FILE* OpenFile(const char* fileName)
                 void sig_handler(int sig)
 
@@ -29,6 +38,25 @@ REVISIONS:      January 31, 2016        (Tyler Trepanier-Bracken)
                     Client has their own definitions of the sig_handler
                     with their own implementations.
 
+                October 17, 2026        (agent)
+                    The size of the message data is read from the limits of
+                    the queue when it is opened and messages are allocated
+                    with Create Message.
+
+                October 17, 2026        (agent)
+                    The key of the queue is made from MSGKEY_PATH and
+                    MSGKEY_ID, shared with libmqclient.
+
+                October 17, 2026        (agent)
+                    Added CREDIT_TYPE for the flow control grants.
+
+                October 17, 2026        (agent)
+                    Send Message stamps the chunks of traced transfers.
+
+                October 17, 2026        (agent)
+                    The stamp is queued after the data of traced chunks only,
+                    every other message is back to a 16 byte header.
+
 DESIGNGER:      Tyler Trepanier-Bracken
 
 PROGRAMMER:     Tyler Trepanier-Bracken
@@ -40,6 +68,9 @@ queue.
 ===============================================================================
 */
 
+#ifndef UTILITIES_H
+#define UTILITIES_H
+
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -47,22 +78,32 @@ queue.
 #include <mqueue.h>
 #include <fcntl.h>
 #include <signal.h>
+#include <time.h>
 #include <sys/ipc.h>
 #include <sys/msg.h>
 #include <sys/errno.h>
 #include "mesg.h"
 
 #define MSGPERM                 0644    // Message queue permissions
+#define SHMPERM                 0600    // Shared memory holding file contents,
+                                        // the owner only
+#define MSGKEY_PATH             "Info"  // Directory the queue key is made from
+#define MSGKEY_ID               'a'     // Project id of the queue key
 #define BUFF                    256     // Small array of character buffer
 #define CLIENT_TO_SERVER        100     // Message type directed to the Server
+#define CREDIT_TYPE(pid)        ((long)(pid) + (1L << 22))  // Grants of a
+                                        // Client, above every possible PID
+#define MSGMAX_PATH             "/proc/sys/kernel/msgmax"
+#define MESG_QUEUE_DEPTH        8       // Largest messages that fit on a queue
 
-/* Global variables */
-int msgQueue;               // The message queue, used for signal handling
-int rc;                     // Error message handler.
+/* Global variables, defined inside of Utilities.c */
+extern int msgQueue;        // The message queue, used for signal handling
+extern int rc;              // Error message handler.
+extern size_t messageData;  // Largest mesg_data sent on the queue.
 
-struct sigaction sa;        // The new signal handler structure.
-struct sigaction oldint;    /* Old signal handler structure which will be 
-                                restored. */
+extern struct sigaction sa;     // The new signal handler structure.
+extern struct sigaction oldint; /* Old signal handler structure which will be 
+                                    restored. */
 
 /*
 ===============================================================================
@@ -75,6 +116,10 @@ REVISIONS:      January 30, 2016    (Tyler Trepanier-Bracken)
                     the message itself.
                 Febuary 1, 2016     (Tyler Trepanier-Bracken)
                     Removed debug statements. 
+                October 17, 2026        (agent)
+                    Uses the number of bytes received to determine the real
+                    length of the message data. No longer sets the global
+                    rc so that threads may share this function.
 
 DESIGNER:       Tyler Trepanier-Bracken
 
@@ -87,8 +132,9 @@ INTERFACE:      int ReadMessage(int queue,
 PARAMETERS:     int queue
                     Message queue to which all messages are sent to.
                 Mesg* msg
-                    Destination message structure which will be filled with
-                    the accompanying message from the message queue.
+                    Destination message structure, from Create Message, which
+                    will be filled with the accompanying message from the
+                    message queue.
                 long msg_type
                     Type of message, used to differiante messages meant for
                     different processes.
@@ -100,10 +146,45 @@ NOTES:
 Reads a message from an existing linux message queue. Uses the IPC_NOWAIT to
 allow this function to immediately return -1 if there are no current messages
 of a mentioned type in the queue.
+
+Messages are variable sized on the queue, the mesg_len is trimmed to the
+number of bytes actually received and the data is terminated with a null
+character.
 ===============================================================================
 */
 int ReadMessage(int queue, Mesg* msg, long msg_type);
 
+/*
+===============================================================================
+FUNCTION:       Read Message No Wait
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int ReadMessageNoWait(int queue, 
+                                      Mesg* msg, 
+                                      long msg_type)
+
+PARAMETERS:     int queue
+                    Message queue to which all messages are sent to.
+                Mesg* msg
+                    Destination message structure.
+                long msg_type
+                    Type of message to read.
+
+RETURNS:        -Returns -1 on failure to read a message, errno is ENOMSG
+                when there is no message of that type.
+                -Returns 0 on received message success.
+
+NOTES:
+Same as Read Message but uses IPC_NOWAIT so it never blocks.
+===============================================================================
+*/
+int ReadMessageNoWait(int queue, Mesg* msg, long msg_type);
+
 /*
 ===============================================================================
 FUNCTION:       Send Message
@@ -116,6 +197,11 @@ REVISIONS:      January 30, 2016    (Tyler Trepanier-Bracken)
                 Febuary 1, 2016     (Tyler Trepanier-Bracken)
                     Inserted the message length calculation inside and 
                     removed all debug statements.
+                October 17, 2026        (agent)
+                    Only the header and the used portion of the mesg_data
+                    are placed onto the message queue. The mesg_len is now
+                    filled in by the caller so binary data can be sent.
+                    No longer sets the global rc.
 
 DESIGNER:       Tyler Trepanier-Bracken
 
@@ -125,7 +211,8 @@ INTERFACE:      int SendMessage(int queue, Mesg* msg)
 
 PARAMETERS:     Mesg* msg
                     Source message structure which will place its message contents
-                    onto the message queue.
+                    onto the message queue. The mesg_len must hold the number
+                    of bytes used inside of the mesg_data.
                 long msg_type
                     Type of message, used to differiante messages meant for
                     different processes.
@@ -137,10 +224,44 @@ NOTES:
 Sends a message from an existing linux message queue. Uses no flags to allow 
 this function to wait on the message queue to free messages to be send if
 there is an excess of messages already inside of the message queue.
+
+The size given to msgsnd is MESGSIZE(mesg_len) rather than the full size of
+the mesg_data so small chunks and the final message do not use up the byte
+limit of the message queue.
+
+A message with a mesg_seq is part of a traced transfer, it is stamped by
+Stamp Message right before msgsnd.
 ===============================================================================
 */
 int SendMessage(int queue, Mesg* msg);
 
+/*
+===============================================================================
+FUNCTION:       Send Message No Wait
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int SendMessageNoWait(int queue, Mesg* msg)
+
+PARAMETERS:     int queue
+                    Message queue to send on.
+                Mesg* msg
+                    Source message structure, the mesg_len must be filled in.
+
+RETURNS:        -Returns -1 on failure to send a message, errno is EAGAIN
+                when the message queue is full.
+                -Returns 0 on success.
+
+NOTES:
+Same as Send Message but uses IPC_NOWAIT so it never blocks.
+===============================================================================
+*/
+int SendMessageNoWait(int queue, Mesg* msg);
+
 /*
 ===============================================================================
 FUNCTION:       Send Final Message 
@@ -165,8 +286,8 @@ RETURNS:        -Returns -1 on failure to send a message.
 
 NOTES:
 Sends a message from an existing linux message queue. Makes use of the 
-pre-existing SendMessage function to send an empty message to a client to 
-CONFIRM a completed message.
+pre-existing SendMessage function to send an empty message (a mesg_len of 0)
+to a client to CONFIRM a completed message.
 ===============================================================================
 */
 int SendFinalMessage(int queue, Mesg* msg);
@@ -221,11 +342,184 @@ RETURNS:        -Returns -1 on failure to open or create a message queue.
 
 NOTES:
 Creates or opens a message queue which will allow interprocess communication
-between the server and clients.
+between the server and clients. The messageData is then sized by the limits
+of the message queue.
 ===============================================================================
 */
 int OpenQueue(void);
 
+/*
+===============================================================================
+FUNCTION:       Queue Message Limit
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      size_t QueueMessageLimit(int queue)
+
+PARAMETERS:     int queue
+                    The SysV message queue.
+
+RETURNS:        The largest mesg_data a message on the queue may carry.
+
+NOTES:
+A message may be no larger than msgmax, and no larger than the msg_qbytes of
+the queue divided by MESG_QUEUE_DEPTH. The Clients sharing the SysV queue
+share its msg_qbytes too, so with only a couple of messages to a queue one
+Client that stops reading blocks every other one. Falls back to
+MAXMESSAGEDATA when neither limit can be read.
+===============================================================================
+*/
+size_t QueueMessageLimit(int queue);
+
+/*
+===============================================================================
+FUNCTION:       Queue Length
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int QueueLength(int queue)
+
+PARAMETERS:     int queue
+                    The SysV message queue.
+
+RETURNS:        -Returns -1 if the queue cannot be read.
+                -Returns the number of messages waiting on the queue.
+===============================================================================
+*/
+int QueueLength(int queue);
+
+/*
+===============================================================================
+FUNCTION:       Read System Limit
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      long ReadSystemLimit(const char* path)
+
+PARAMETERS:     const char* path
+                    A file under /proc/sys holding a single number.
+
+RETURNS:        -Returns -1 if the file cannot be read.
+                -Returns the number otherwise.
+===============================================================================
+*/
+long ReadSystemLimit(const char* path);
+
+/*
+===============================================================================
+FUNCTION:       Create Message
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      Mesg* CreateMessage(void)
+
+PARAMETERS:     void
+
+RETURNS:        -Returns NULL when out of memory.
+                -Returns the new message, which is released with free.
+
+NOTES:
+Allocates a message with room for messageData bytes plus the null
+terminator added by the read functions. The queue must have been opened
+first so the messageData matches the queue. The mesg_id and mesg_seq start
+at 0, the rest of the message is not cleared.
+===============================================================================
+*/
+Mesg* CreateMessage(void);
+
+/*
+===============================================================================
+FUNCTION:       Stamp Message
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      size_t StampMessage(Mesg* msg)
+
+PARAMETERS:     Mesg* msg
+                    Message about to be queued.
+
+RETURNS:        The number of bytes to queue after the mesg_type.
+
+NOTES:
+A message with a mesg_seq gets its mesg_sent set to Monotonic Ns, and both
+are copied right after its mesg_len bytes of data. Untraced messages carry
+no stamp. A traced chunk with less than MESGSTAMP bytes left in the
+messageData goes out without its stamp, so the senders keep traced chunks
+that much shorter.
+===============================================================================
+*/
+size_t StampMessage(Mesg* msg);
+
+/*
+===============================================================================
+FUNCTION:       Received Message
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      int ReceivedMessage(Mesg* msg, ssize_t n)
+
+PARAMETERS:     Mesg* msg
+                    Message just read off of a queue.
+                ssize_t n
+                    Bytes read after the mesg_type, or -1.
+
+RETURNS:        -Returns -1 if nothing was read or the message is shorter
+                 than its header, errno is EBADMSG for the latter.
+                -Returns 0 on success.
+
+NOTES:
+Shared by the SysV and POSIX read functions. Exactly MESGSTAMP bytes past
+the data are the stamp of a traced message, they fill in mesg_seq and
+mesg_sent which are 0 otherwise. Otherwise the mesg_len is trimmed to the
+bytes received. The data is then terminated with a null character.
+===============================================================================
+*/
+int ReceivedMessage(Mesg* msg, ssize_t n);
+
+/*
+===============================================================================
+FUNCTION:       Monotonic Ns
+
+DATE:           October 17, 2026
+
+DESIGNER:       agent
+
+PROGRAMMER(S):  agent
+
+INTERFACE:      long long MonotonicNs(void)
+
+PARAMETERS:     void
+
+RETURNS:        The CLOCK_MONOTONIC time in nanoseconds, the same clock in
+                every process of the machine.
+===============================================================================
+*/
+long long MonotonicNs(void);
+
 /*
 ===============================================================================
 FUNCTION:       sig_handler 
@@ -282,4 +576,6 @@ NOTES:
 Simple wrapper function that attempts to open a file for reading. 
 ===============================================================================
 */
-FILE* OpenFile(const char* fileName);
\ No newline at end of file
+FILE* OpenFile(const char* fileName);
+
+#endif
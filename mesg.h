@@ -16,6 +16,23 @@ REVISIONS:		January 30, 2016
 					Changed the position of the mesg_len inside of the Mesg
 					definition, the mesg_type was being inserted inside of
 					there inside of the message queue.
+				October 17, 2026		(agent)
+					Added MESGHEADER and MESGSIZE so that only the header and
+					the bytes actually used in mesg_data are placed onto the
+					message queue.
+				October 17, 2026		(agent)
+					The mesg_data is now a flexible array member. Messages are
+					allocated with CreateMessage, sized by the limits of the
+					queue, and MAXMESSAGEDATA is only the fallback size.
+				October 17, 2026		(agent)
+					Added mesg_id so the replies to several requests of one
+					Client may share its queue.
+				October 17, 2026		(agent)
+					Added mesg_seq and mesg_sent for the latency traces.
+				October 17, 2026		(agent)
+					Moved mesg_seq and mesg_sent ahead of the mesg_type so
+					they are never queued, a traced message carries them
+					after its data instead (MESGSTAMP).
 
 DESIGNGER:      Tyler Trepanier-Bracken
 
@@ -24,12 +41,17 @@ PROGRAMMER:     Tyler Trepanier-Bracken
 NOTES:
 This is the message structure that contains all the necessary elements for a
 message to be sent on the linux message queue. This file is used by the Client,
-Server and Utilities files which use the MAXMESSAGEDATA definition to determine
+Server and Utilities files which use the size of the message data to determine
 the priority.
 ===============================================================================
 */
 
- /* Maximum message size allowed on the message queue. */
+#ifndef MESG_H
+#define MESG_H
+
+#include <stddef.h>
+
+ /* Message data size used when the limits of the queue cannot be read. */
 #define MAXMESSAGEDATA 	2048
 
 /*
@@ -38,7 +60,27 @@ process
 */
 typedef struct
 {
-	long mesg_type; /* message type */
+	unsigned long mesg_seq; /* chunk number when traced, 0 if not, see Trace.h */
+	long long mesg_sent; /* CLOCK_MONOTONIC ns when queued, if mesg_seq > 0 */
+	long mesg_type; /* message type, the queues are handed &mesg_type */
+	long mesg_id; /* request the message belongs to, 0 for none */
 	size_t mesg_len; /* #bytes in mesg_data */
-	char mesg_data[MAXMESSAGEDATA];
+	char mesg_data[]; /* messageData bytes, see CreateMessage */
 } Mesg;
+
+/*
+Number of bytes between the mesg_type and the mesg_data. The mesg_type is not
+counted by msgsnd/msgrcv so it is excluded from the message size.
+*/
+#define MESGHEADER		(offsetof(Mesg, mesg_data) - offsetof(Mesg, mesg_id))
+
+/*
+Bytes of mesg_seq and mesg_sent. Only a traced message carries them, right
+after its mesg_len bytes of mesg_data, so it needs that much room left.
+*/
+#define MESGSTAMP		offsetof(Mesg, mesg_type)
+
+/* Size of a message on the queue which carries len bytes of mesg_data. */
+#define MESGSIZE(len)	(MESGHEADER + (len))
+
+#endif